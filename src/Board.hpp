@@ -5,159 +5,240 @@
 #include <string>
 #include <numeric>
 #include <cmath>
+#include <cstdint>
 #include <algorithm>
 #include <functional>
 #include <array>
+#include <type_traits>
 
-// 定义棋盘状态的结构体
-struct Board {
-    int N; // 行数 (rows)
-    int M; // 列数 (columns)
-    std::vector<int> tiles; // 棋盘上的数字，0 代表空格 (empty space)
-    int empty_row;          // 空格的行坐标
-    int empty_col;          // 空格的列坐标
-
-    // 构造函数
-    Board(int n, int m, const std::vector<int>& initial_tiles) : N(n), M(m), tiles(initial_tiles) {
-        for (int i = 0; i < N * M; ++i) {
-            if (tiles[i] == 0) {
-                empty_row = i / M;
-                empty_col = i % M;
-                break;
+#include "HeuristicKernels.hpp"
+#include "ShapeTables.hpp"
+#include "Zobrist.hpp"
+
+__extension__ typedef unsigned __int128 uint128_t;
+
+// 运行期尺寸：行列数随棋盘一起保存，适用于没有编译期特化的棋盘形状
+struct DynamicShape {
+    const ShapeTables* shape = nullptr; // 该形状的查找表，由 shape_tables() 缓存
+    uint8_t N = 0; // 行数 (rows)
+    uint8_t M = 0; // 列数 (columns)
+
+    DynamicShape() = default;
+    DynamicShape(int n, int m) : shape(&shape_tables(n, m)), N(static_cast<uint8_t>(n)), M(static_cast<uint8_t>(m)) {}
+
+    int rows() const { return N; }
+    int cols() const { return M; }
+    const ShapeTables& tables() const { return *shape; }
+};
+
+// 编译期尺寸：行列数是常量，除法、取模和循环边界都可以被编译器展开；空类，不占棋盘空间
+template <int R, int C>
+struct FixedShape {
+    FixedShape() = default;
+    FixedShape(int, int) {}
+
+    static constexpr int rows() { return R; }
+    static constexpr int cols() { return C; }
+
+    static constexpr ShapeTables kTables = make_shape_tables(R, C);
+    static const ShapeTables& tables() { return kTables; }
+};
+
+// 定长打包棋盘：每格 Bits 位，共 Words 个 Word；Shape 提供行列数（DynamicShape 或 FixedShape）。
+// 第 i 格位于第 i / kCellsPerWord 个字的第 (i % kCellsPerWord) * Bits 位起，格子不跨字，0 代表空格。
+// 交换、比较和目标判断都只需要常数次字运算，不涉及堆分配。
+// 哈希为 Zobrist 哈希，随棋盘一起保存，每次移动 O(1) 更新，并发哈希表直接复用而不必逐格重算。
+template <typename Shape, typename Word, int Bits, int Words>
+struct PackedBoard : Shape {
+    static constexpr int kBitsPerCell = Bits;
+    static constexpr int kWords = Words;
+    static constexpr int kCellsPerWord = static_cast<int>(sizeof(Word) * 8) / Bits;
+    static constexpr int kMaxCells = std::min(kCellsPerWord * Words, 1 << Bits);
+    static constexpr Word kCellMask = (static_cast<Word>(1) << Bits) - 1;
+
+    std::array<Word, Words> words{}; // 打包后的棋盘数字
+    uint64_t zobrist = 0; // 棋盘的 Zobrist 哈希，由 words 唯一决定
+    uint8_t blank = 0;    // 空格所在的格子下标（缓存，避免每次扫描）
+
+    PackedBoard() = default;
+
+    // 构造函数：initial_tiles 按行优先顺序给出，长度为 n * m 且不超过 kMaxCells
+    PackedBoard(int n, int m, const std::vector<int>& initial_tiles)
+        : Shape(n, m) {
+        for (int i = 0; i < n * m; ++i) {
+            words[i / kCellsPerWord] |= (static_cast<Word>(initial_tiles[i]) & kCellMask) << shift_of(i);
+            zobrist ^= kZobristKeys[i][initial_tiles[i] & kCellMask];
+            if (initial_tiles[i] == 0) {
+                blank = static_cast<uint8_t>(i);
             }
         }
     }
 
-    // 拷贝构造函数和赋值运算符（默认即可，std::vector 会正确处理深拷贝）
-    Board() = default;
-    Board(const Board& other) = default;
-    Board& operator=(const Board& other) = default;
+    static bool fits(int n, int m) { return n * m <= kMaxCells; }
+
+    static constexpr int shift_of(int idx) { return (idx % kCellsPerWord) * Bits; }
+
+    using Shape::rows;
+    using Shape::cols;
+    using Shape::tables;
 
-    // 相等运算符 (用于 std::map 或 std::unordered_map 的键比较)
-    bool operator==(const Board& other) const {
-        return tiles == other.tiles; // 比较底层数字向量是否相同
+
+    int size() const { return rows() * cols(); }
+    int empty_row() const { return blank / cols(); }
+    int empty_col() const { return blank % cols(); }
+
+    // 读取第 idx 格的数字
+    int at(int idx) const {
+        return static_cast<int>((words[idx / kCellsPerWord] >> shift_of(idx)) & kCellMask);
     }
 
-    // 小于运算符 (用于 std::map 或 std::set 的排序，或作为 std::priority_queue 的次要排序规则)
-    bool operator<(const Board& other) const {
-        // 字典序比较，确保 std::set<Solution> 中的 Board 路径能够被正确比较和排序
-        if (N != other.N || M != other.M) {
-            // 如果尺寸不同，比较尺寸，或者可以抛出异常，这里简单处理
-            return N < other.N || (N == other.N && M < other.M);
+    // 解包成按行优先排列的数字序列，仅用于输出
+    std::vector<int> to_tiles() const {
+        std::vector<int> tiles(size());
+        for (int i = 0; i < size(); ++i) {
+            tiles[i] = at(i);
         }
-        return tiles < other.tiles;
+        return tiles;
     }
 
-    // 检查当前棋盘是否达到目标状态
-    // 目标状态：1, 2, ..., N*M-1, 0 (空格在最后)
-    bool is_goal() const {
-        for (int i = 0; i < N * M - 1; ++i) {
-            if (tiles[i] != i + 1) {
-                return false;
-            }
-        }
-        return tiles[N * M - 1] == 0; // 确保最后一个位置是空格
+    bool operator==(const PackedBoard& other) const {
+        return words == other.words;
     }
 
-    // 计算当前棋盘的曼哈顿距离启发式值
-    // 曼哈顿距离：每个数字到其目标位置的水平距离和垂直距离之和
-    int get_manhattan_distance() const {
-        int h = 0;
-        for (int i = 0; i < N * M; ++i) {
-            int val = tiles[i];
-            if (val == 0) continue; // 空格不参与曼哈顿距离计算
+    bool operator<(const PackedBoard& other) const {
+        return words < other.words;
+    }
 
-            int current_row = i / M;
-            int current_col = i % M;
+    // 目标状态 1, 2, ..., N*M-1, 0 的打包形式，按格子数缓存，整盘只比较 Words 个字
+    static const std::array<Word, Words>& goal_words(int cell_count) {
+        static const auto table = [] {
+            std::array<std::array<Word, Words>, kMaxCells + 1> goals{};
+            for (int n = 1; n <= kMaxCells; ++n) {
+                for (int i = 0; i < n - 1; ++i) {
+                    goals[n][i / kCellsPerWord] |= static_cast<Word>(i + 1) << shift_of(i);
+                }
+            }
+            return goals;
+        }();
+        return table[cell_count];
+    }
 
-            // 目标位置索引：数字 val 应该在的索引是 val - 1
-            int target_idx = val - 1;
-            int target_row = target_idx / M;
-            int target_col = target_idx % M;
+    bool is_goal() const {
+        return words == goal_words(size());
+    }
 
-            h += std::abs(current_row - target_row) + std::abs(current_col - target_col);
+    // 解包成定长字节数组，供整盘评估内核使用
+    UnpackedTiles unpack() const {
+        UnpackedTiles tiles{};
+        for (int i = 0; i < size(); ++i) {
+            tiles[i] = static_cast<uint8_t>(at(i));
         }
-        return h;
+        return tiles;
     }
 
-    // 生成相邻交换规则 (Type 1) 下的邻居状态
-    std::vector<Board> get_neighbors_adjacent_swap() const {
-        std::vector<Board> neighbors;
-        int dr[] = {-1, 1, 0, 0}; // 方向向量：上，下，左，右
-        int dc[] = {0, 0, -1, 1};
-
-        for (int i = 0; i < 4; ++i) {
-            int new_row = empty_row + dr[i];
-            int new_col = empty_col + dc[i];
-
-            // 检查新位置是否在棋盘范围内
-            if (new_row >= 0 && new_row < N && new_col >= 0 && new_col < M) {
-                Board new_board = *this; // 拷贝当前棋盘状态
-                int new_empty_idx = new_row * M + new_col;
-                int old_empty_idx = empty_row * M + empty_col;
-
-                // 交换空格和相邻的数字
-                std::swap(new_board.tiles[old_empty_idx], new_board.tiles[new_empty_idx]);
-                new_board.empty_row = new_row;
-                new_board.empty_col = new_col;
-                neighbors.push_back(new_board);
-            }
+    // 用启动时按 CPU 特性选定的 SIMD 内核从头评估整盘
+    BoardEvaluation evaluate() const {
+        return evaluate_board(unpack(), rows(), cols());
+    }
+
+    // 从头计算当前棋盘的曼哈顿距离启发式值，只用于初始状态；
+    // 搜索过程中子状态的值由邻居枚举函数增量维护
+    int get_manhattan_distance() const {
+        return evaluate().manhattan;
+    }
+
+    // 把 idx 格的数字移入空格，idx 成为新的空格
+    // 空格对应的位段为 0，因此两次异或即可同时完成“放入”和“清空”，哈希同理
+    void move_blank_to(int idx) {
+        Word tile = (words[idx / kCellsPerWord] >> shift_of(idx)) & kCellMask;
+        words[blank / kCellsPerWord] ^= tile << shift_of(blank);
+        words[idx / kCellsPerWord] ^= tile << shift_of(idx);
+        zobrist ^= kZobristKeys[blank][static_cast<int>(tile)] ^ kZobristKeys[idx][static_cast<int>(tile)];
+        blank = static_cast<uint8_t>(idx);
+    }
+
+    // 枚举相邻交换规则 (Type 1) 下的邻居状态
+    // manhattan: 当前棋盘的曼哈顿距离；一次交换只改变被移动数字的距离，子状态的值按增量得到
+    // directions: 需要生成的空格移动方向位掩码（第 dir 位对应方向 dir），由 MovePruning.hpp 的剪枝表给出
+    // visit(const PackedBoard& child, int child_manhattan, int direction) 对每个邻居调用一次，子棋盘在栈上原地构造，不分配堆内存
+    // 合法交换从预先计算的走法表中读取，不做边界判断
+    template <typename Visitor>
+    void for_each_adjacent_swap(int manhattan, unsigned directions, Visitor&& visit) const {
+        const ShapeTables& t = tables();
+        const ShapeTables::AdjacentMoves& moves = t.adjacent[blank];
+
+        for (int i = 0; i < moves.count; ++i) {
+            int dir = moves.direction[i];
+            if (!((directions >> dir) & 1u)) continue;
+            int idx = moves.target[i];
+            PackedBoard child = *this;
+            child.move_blank_to(idx);
+            visit(static_cast<const PackedBoard&>(child), manhattan + t.manhattan_delta(at(idx), idx, blank), dir);
         }
-        return neighbors;
     }
 
-    // 生成批量位移规则 (Type 2) 下的邻居状态
+    // 枚举批量位移规则 (Type 2) 下的邻居状态
     // 这个规则下，一次操作可以将空格“跳过”一串连续的数字方块，将整串数字批量移动，每次计1分。
     // 例如：棋盘是 [_, 1, 2, 3]。
     // 第一次循环：将1移动到空格位置 -> [1, _, 2, 3]，这作为一个新的邻居状态，成本1。
     // 第二次循环：将2移动到新的空格位置 -> [1, 2, _, 3]，这作为一个新的邻居状态，成本1。
     // 第三次循环：将3移动到新的空格位置 -> [1, 2, 3, _]，这作为一个新的邻居状态，成本1。
     // 每次“批量位移”操作（无论移动了多少个方块）都只算1分。
-    std::vector<Board> get_neighbors_block_shift() const {
-        std::vector<Board> neighbors;
-        int dr[] = {-1, 1, 0, 0}; // 方向向量：上，下，左，右
-        int dc[] = {0, 0, -1, 1};
+    // 沿同一方向每多推进一格，只多移动一个数字，因此曼哈顿距离沿射线逐格累加增量即可
+    // directions 与 visit 的约定同 for_each_adjacent_swap，同一方向上不同长度的位移报告相同的 direction
+    // 每个方向的射线长度从预先计算的走法表中读取，不做边界判断
+    //
+    // 单字表示 (Board16 / Board25 及对应的 Board<N, M>) 使用位并行生成：
+    // 射线上前 k 个格子在行优先打包字中的位段构成掩码，第 k 个子状态就是父棋盘把掩码内的位段
+    // 整体朝空格方向平移一格（水平方向移 Bits 位，竖直方向移 cols * Bits 位）。
+    // 空格位段为 0，平移后射线末端自然被清零成为新空格，因此每个子状态只需几条位运算，且互不依赖；
+    // 竖直方向的步长掩码在行优先编码上同样成立，不需要额外维护列优先的影子编码。
+    // 多字表示 (Board64) 的射线可能跨字，沿射线逐格移动空格。
+    template <typename Visitor>
+    void for_each_block_shift(int manhattan, unsigned directions, Visitor&& visit) const {
+        const ShapeTables& t = tables();
 
-        for (int i = 0; i < 4; ++i) { // 遍历四个方向
-            int dir_r = dr[i];
-            int dir_c = dc[i];
+        for (int dir = 0; dir < ShapeTables::kDirections; ++dir) { // 遍历四个方向
+            if (!((directions >> dir) & 1u)) continue;
+            const int step = t.step[dir];
+            const int length = t.ray_length[blank][dir];
+            PackedBoard child = *this;
+            int current_manhattan = manhattan;
+            int idx = blank;
 
-            // 用于在临时棋盘上执行批量位移
-            Board current_shifted_board = *this; // 从当前棋盘开始
-
-            // 沿着当前方向，从紧邻空格的第一个数字开始尝试批量位移
-            int current_r = empty_row + dir_r;
-            int current_c = empty_col + dir_c;
-
-            while (current_r >= 0 && current_r < N && current_c >= 0 && current_c < M) {
-                int current_tile_idx = current_r * M + current_c;
-                int prev_empty_idx = (current_r - dir_r) * M + (current_c - dir_c);
-
-                // 在 current_shifted_board 上执行交换，移动方块到空格原位置
-                std::swap(current_shifted_board.tiles[current_tile_idx], current_shifted_board.tiles[prev_empty_idx]);
-
-                // 更新 current_shifted_board 的空格位置
-                current_shifted_board.empty_row = current_r;
-                current_shifted_board.empty_col = current_c;
-
-                // 将当前这个批量位移后的棋盘状态添加到邻居列表
-                // 每次这种位移操作都算作一步
-                neighbors.push_back(current_shifted_board);
-
-                // 移动到下一个位置，考虑更大的批量位移
-                current_r += dir_r;
-                current_c += dir_c;
+            if constexpr (Words == 1) {
+                const int shift = (step > 0 ? step : -step) * Bits;
+                Word mask = 0;
+                for (int k = 0; k < length; ++k) {
+                    int prev = idx;
+                    idx += step;
+                    int tile = at(idx);
+                    mask |= kCellMask << shift_of(idx);
+                    Word moved = words[0] & mask;
+                    child.words[0] = (words[0] & ~mask) | (step > 0 ? moved >> shift : moved << shift);
+                    child.zobrist ^= kZobristKeys[prev][tile] ^ kZobristKeys[idx][tile];
+                    child.blank = static_cast<uint8_t>(idx);
+                    current_manhattan += t.manhattan_delta(tile, idx, prev);
+                    visit(static_cast<const PackedBoard&>(child), current_manhattan, dir);
+                }
+            } else {
+                // 在临时棋盘上沿当前方向逐格推进空格，每推进一格得到一个批量位移后的状态
+                for (int k = 0; k < length; ++k) {
+                    idx += step;
+                    current_manhattan += t.manhattan_delta(at(idx), idx, child.blank);
+                    child.move_blank_to(idx);
+                    visit(static_cast<const PackedBoard&>(child), current_manhattan, dir);
+                }
             }
         }
-        return neighbors;
     }
 
     // 用于调试或打印棋盘状态
     std::string to_string() const {
         std::string s = "";
-        for (int r = 0; r < N; ++r) {
-            for (int c = 0; c < M; ++c) {
-                int val = tiles[r * M + c];
+        for (int r = 0; r < rows(); ++r) {
+            for (int c = 0; c < cols(); ++c) {
+                int val = at(r * cols() + c);
                 if (val == 0) {
                     s += "  "; // 空格用两个空格表示
                 } else {
@@ -172,19 +253,24 @@ struct Board {
     }
 };
 
-// 为 Board 结构体特化 std::hash，以便在 std::unordered_map 和 tbb::concurrent_unordered_map 中作为键
+// 常用的三档打包宽度，PuzzleSolver::solve 对没有编译期特化的形状选择能容纳棋盘的最窄一档
+using Board16 = PackedBoard<DynamicShape, uint64_t, 4, 1>;  // 不超过 16 格 (3x5, 2x8, ...)：每格 4 位，一个 64 位字
+using Board25 = PackedBoard<DynamicShape, uint128_t, 5, 1>; // 不超过 25 格 (4x6, 3x7, ...)：每格 5 位，一个 128 位字
+using Board64 = PackedBoard<DynamicShape, uint64_t, 6, 7>;  // 不超过 64 格：每格 6 位，每字 10 格，共 7 个字
+
+// 编译期特化的棋盘 Board<N, M>，打包宽度同样按格子数取最窄的一档
+template <int N, int M>
+using Board = std::conditional_t<(N * M <= 16), PackedBoard<FixedShape<N, M>, uint64_t, 4, 1>,
+              std::conditional_t<(N * M <= 25), PackedBoard<FixedShape<N, M>, uint128_t, 5, 1>,
+                                                PackedBoard<FixedShape<N, M>, uint64_t, 6, 7>>>;
+
+// 为打包棋盘特化 std::hash，以便在 std::unordered_map 和 tbb::concurrent_unordered_map 中作为键
+// 直接返回棋盘内维护的 Zobrist 哈希
 namespace std {
-    template <>
-    struct hash<Board> {
-        size_t operator()(const Board& board) const {
-            // 使用 Boost 的 hash_combine 思想来组合向量中元素的哈希值
-            // 这是一个相对快速且分布性较好的哈希函数
-            size_t seed = board.tiles.size();
-            for (int i : board.tiles) {
-                // 经典的 hash_combine 乘法和异或混合操作
-                seed ^= i + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-            }
-            return seed;
+    template <typename Shape, typename Word, int Bits, int Words>
+    struct hash<PackedBoard<Shape, Word, Bits, Words>> {
+        size_t operator()(const PackedBoard<Shape, Word, Bits, Words>& board) const {
+            return static_cast<size_t>(board.zobrist);
         }
     };
 }
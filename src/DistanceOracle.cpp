@@ -0,0 +1,400 @@
+#include "DistanceOracle.hpp"
+#include "PermutationRank.hpp"
+#include "ShapeTables.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <utility>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_reduce.h>
+
+#include <spdlog/spdlog.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define DISTANCE_ORACLE_USE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// 距离表文件头，固定 64 字节，表数据紧随其后
+struct OracleFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t rows;
+    uint32_t cols;
+    uint32_t solve_type;   // 0 相邻交换，1 批量位移
+    uint64_t state_count;  // 可解状态数 (N*M)!/2
+    uint32_t max_distance;
+    uint32_t modulus;      // 距离存储的模数
+    uint8_t reserved[24];
+};
+static_assert(sizeof(OracleFileHeader) == 64, "oracle file header must stay 64 bytes");
+
+constexpr char kOracleMagic[8] = {'N', 'S', 'S', 'O', 'R', 'C', 'L', '\0'};
+constexpr uint32_t kOracleVersion = 1;
+
+const char* solve_type_name(SolveType type) {
+    return type == SolveType::AdjacentSwap ? "adjacent" : "block";
+}
+
+// 原地对 tiles 依次应用空格位于 blank 时 type 规则下的每一种移动，回调 visit(新的空格位置)，回调返回后恢复 tiles。
+// 批量位移按方向逐格推进，每推进一格即为一个邻居，与 PackedBoard::for_each_block_shift 的枚举顺序一致
+template <typename Visitor>
+void for_each_move(const ShapeTables& t, SolveType type, uint8_t* tiles, int blank, Visitor&& visit) {
+    if (type == SolveType::AdjacentSwap) {
+        const ShapeTables::AdjacentMoves& moves = t.adjacent[blank];
+        for (int i = 0; i < moves.count; ++i) {
+            int target = moves.target[i];
+            std::swap(tiles[blank], tiles[target]);
+            visit(target);
+            std::swap(tiles[blank], tiles[target]);
+        }
+        return;
+    }
+    for (int dir = 0; dir < ShapeTables::kDirections; ++dir) {
+        const int step = t.step[dir];
+        int pos = blank;
+        for (int k = 0; k < t.ray_length[blank][dir]; ++k) {
+            std::swap(tiles[pos], tiles[pos + step]);
+            pos += step;
+            visit(pos);
+        }
+        for (; pos != blank; pos -= step) {
+            std::swap(tiles[pos], tiles[pos - step]);
+        }
+    }
+}
+
+int find_blank(const uint8_t* tiles, int cells) {
+    for (int pos = 0; pos < cells; ++pos) {
+        if (tiles[pos] == 0) {
+            return pos;
+        }
+    }
+    return -1;
+}
+
+bool is_goal_tiles(const uint8_t* tiles, int cells) {
+    for (int pos = 0; pos + 1 < cells; ++pos) {
+        if (tiles[pos] != pos + 1) {
+            return false;
+        }
+    }
+    return tiles[cells - 1] == 0;
+}
+
+} // namespace
+
+bool DistanceOracle::supports(int rows, int cols) {
+    return rows >= 2 && cols >= 2 && rows * cols <= kMaxCells;
+}
+
+std::shared_ptr<const DistanceOracle> DistanceOracle::get(int rows, int cols, SolveType type) {
+    if (!supports(rows, cols)) {
+        return nullptr;
+    }
+    static std::mutex registry_mutex;
+    static std::map<std::tuple<int, int, SolveType>, std::shared_ptr<const DistanceOracle>> registry;
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    auto& slot = registry[{rows, cols, type}];
+    if (slot) {
+        return slot;
+    }
+
+    // 只映射已有文件；缺失时不缓存，oracle_builder 写出文件后同一进程的下次求解即可使用
+    std::shared_ptr<DistanceOracle> oracle(new DistanceOracle(rows, cols, type));
+    if (!oracle->map_file(file_path(rows, cols, type))) {
+        return nullptr;
+    }
+    slot = oracle;
+    return slot;
+}
+
+std::shared_ptr<DistanceOracle> DistanceOracle::build(int rows, int cols, SolveType type) {
+    if (!supports(rows, cols)) {
+        spdlog::default_logger()->error("No distance oracle for {}x{}: needs at least 2 rows and columns and at most {} cells.", rows, cols, kMaxCells);
+        return nullptr;
+    }
+    std::shared_ptr<DistanceOracle> oracle(new DistanceOracle(rows, cols, type));
+    spdlog::default_logger()->info("Building {}x{} {} distance oracle ({} states)...", rows, cols, solve_type_name(type), oracle->state_count_);
+    auto start = std::chrono::steady_clock::now();
+    oracle->build_table();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    spdlog::default_logger()->info("Distance oracle built in {:.2f} seconds, max distance {}.", elapsed.count(), oracle->max_distance_);
+    return oracle;
+}
+
+DistanceOracle::DistanceOracle(int rows, int cols, SolveType type)
+    : rows_(rows), cols_(cols), type_(type), state_count_(BoardRanker(rows, cols).state_count()) {}
+
+DistanceOracle::~DistanceOracle() {
+#ifdef DISTANCE_ORACLE_USE_MMAP
+    if (mapping_ != nullptr) {
+        munmap(mapping_, mapping_size_);
+    }
+#endif
+}
+
+std::string DistanceOracle::file_path(int rows, int cols, SolveType type) {
+    const char* dir = std::getenv("NUMBER_SLIDER_ORACLE_DIR");
+    std::filesystem::path base = (dir != nullptr && dir[0] != '\0') ? dir : "oracles";
+    std::string name = "oracle_" + std::to_string(rows) + "x" + std::to_string(cols) + "_" + solve_type_name(type) + ".bin";
+    return (base / name).string();
+}
+
+bool DistanceOracle::map_file(const std::string& path) {
+    const uint64_t table_bytes = (state_count_ + 1) / 2;
+    auto header_matches = [&](const OracleFileHeader& header, uint64_t file_size) {
+        return std::memcmp(header.magic, kOracleMagic, sizeof(kOracleMagic)) == 0 &&
+               header.version == kOracleVersion &&
+               header.rows == static_cast<uint32_t>(rows_) && header.cols == static_cast<uint32_t>(cols_) &&
+               header.solve_type == static_cast<uint32_t>(type_) &&
+               header.state_count == state_count_ && header.modulus == kModulus &&
+               file_size == sizeof(OracleFileHeader) + table_bytes;
+    };
+
+#ifdef DISTANCE_ORACLE_USE_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) != 0 || static_cast<uint64_t>(st.st_size) < sizeof(OracleFileHeader)) {
+        ::close(fd);
+        return false;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void* base = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        return false;
+    }
+    OracleFileHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    if (!header_matches(header, size)) {
+        spdlog::default_logger()->warn("Ignoring distance oracle {} with mismatched header.", path);
+        ::munmap(base, size);
+        return false;
+    }
+    // 下降时按排名随机访问，关闭预读
+    ::madvise(base, size, MADV_RANDOM);
+    mapping_ = base;
+    mapping_size_ = size;
+    table_ = static_cast<const uint8_t*>(base) + sizeof(OracleFileHeader);
+#else
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    OracleFileHeader header;
+    in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    std::error_code ec;
+    uint64_t size = std::filesystem::file_size(path, ec);
+    if (!in || ec || !header_matches(header, size)) {
+        spdlog::default_logger()->warn("Ignoring distance oracle {} with mismatched header.", path);
+        return false;
+    }
+    owned_table_.resize(table_bytes);
+    in.read(reinterpret_cast<char*>(owned_table_.data()), static_cast<std::streamsize>(table_bytes));
+    if (!in) {
+        owned_table_.clear();
+        return false;
+    }
+    table_ = owned_table_.data();
+#endif
+    max_distance_ = static_cast<int>(header.max_distance);
+    spdlog::default_logger()->info("Loaded {}x{} {} distance oracle from {}.", rows_, cols_, solve_type_name(type_), path);
+    return true;
+}
+
+// 逐层并行 BFS：frontier 位图标记当前层的状态，每个状态展开后用原子与操作认领尚未访问的子状态，
+// 认领成功者把子状态写入 next 位图，同一层内重复发现的子状态只计一次
+void DistanceOracle::build_table() {
+    const ShapeTables& t = shape_tables(rows_, cols_);
+    const BoardRanker ranker(rows_, cols_);
+    const int cells = rows_ * cols_;
+
+    owned_table_.assign((state_count_ + 1) / 2, 0xFF);
+    uint8_t* table = owned_table_.data();
+    const size_t frontier_words = static_cast<size_t>((state_count_ + 63) / 64);
+    std::vector<uint64_t> frontier(frontier_words, 0);
+    std::vector<uint64_t> next(frontier_words, 0);
+
+    std::array<uint8_t, kRankMaxCells> goal{};
+    for (int pos = 0; pos + 1 < cells; ++pos) {
+        goal[pos] = static_cast<uint8_t>(pos + 1);
+    }
+    uint64_t goal_rank = ranker.rank(goal.data());
+    table[goal_rank >> 1] &= static_cast<uint8_t>(~(kUnvisited << ((goal_rank & 1) * 4)));
+    frontier[goal_rank >> 6] |= 1ULL << (goal_rank & 63);
+
+    uint64_t visited = 1;
+    int depth = 0;
+    while (true) {
+        const uint8_t child_value = static_cast<uint8_t>((depth + 1) % kModulus);
+        uint64_t found = tbb::parallel_reduce(
+            tbb::blocked_range<size_t>(0, frontier_words), uint64_t{0},
+            [&](const tbb::blocked_range<size_t>& range, uint64_t count) {
+                std::array<uint8_t, kRankMaxCells> tiles{};
+                for (size_t w = range.begin(); w != range.end(); ++w) {
+                    for (uint64_t bits = frontier[w]; bits != 0; bits &= bits - 1) {
+                        ranker.unrank(w * 64 + __builtin_ctzll(bits), tiles.data());
+                        for_each_move(t, type_, tiles.data(), find_blank(tiles.data(), cells), [&](int) {
+                            uint64_t child = ranker.rank(tiles.data());
+                            uint8_t* byte = table + (child >> 1);
+                            const int shift = static_cast<int>(child & 1) * 4;
+                            if (((__atomic_load_n(byte, __ATOMIC_RELAXED) >> shift) & 0xF) != kUnvisited) {
+                                return;
+                            }
+                            uint8_t keep = static_cast<uint8_t>(~(kUnvisited << shift) | (child_value << shift));
+                            uint8_t old = __atomic_fetch_and(byte, keep, __ATOMIC_RELAXED);
+                            if (((old >> shift) & 0xF) == kUnvisited) {
+                                __atomic_fetch_or(&next[child >> 6], 1ULL << (child & 63), __ATOMIC_RELAXED);
+                                ++count;
+                            }
+                        });
+                    }
+                }
+                return count;
+            },
+            std::plus<uint64_t>());
+        if (found == 0) {
+            break;
+        }
+        ++depth;
+        visited += found;
+        spdlog::default_logger()->debug("Distance oracle depth {}: {} states.", depth, found);
+        frontier.swap(next);
+        std::fill(next.begin(), next.end(), 0);
+    }
+
+    if (visited != state_count_) {
+        spdlog::default_logger()->warn("Distance oracle reached {} of {} states.", visited, state_count_);
+    }
+    max_distance_ = depth;
+    table_ = owned_table_.data();
+}
+
+// 先写临时文件再改名，并发启动的进程不会映射到写了一半的文件
+bool DistanceOracle::write_file(const std::string& path) const {
+    std::error_code ec;
+    std::filesystem::path target(path);
+    if (target.has_parent_path()) {
+        std::filesystem::create_directories(target.parent_path(), ec);
+    }
+
+    OracleFileHeader header{};
+    std::memcpy(header.magic, kOracleMagic, sizeof(kOracleMagic));
+    header.version = kOracleVersion;
+    header.rows = static_cast<uint32_t>(rows_);
+    header.cols = static_cast<uint32_t>(cols_);
+    header.solve_type = static_cast<uint32_t>(type_);
+    header.state_count = state_count_;
+    header.max_distance = static_cast<uint32_t>(max_distance_);
+    header.modulus = kModulus;
+
+    const std::string temp_path = path + ".tmp";
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(table_), static_cast<std::streamsize>((state_count_ + 1) / 2));
+        if (!out) {
+            return false;
+        }
+    }
+    std::filesystem::rename(temp_path, target, ec);
+    if (ec) {
+        std::remove(temp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+int DistanceOracle::distance(const uint8_t* start) const {
+    const ShapeTables& t = shape_tables(rows_, cols_);
+    const BoardRanker ranker(rows_, cols_);
+    const int cells = rows_ * cols_;
+
+    std::array<uint8_t, kRankMaxCells> tiles{};
+    std::copy(start, start + cells, tiles.begin());
+    int blank = find_blank(tiles.data(), cells);
+    uint8_t value = value_at(ranker.rank(tiles.data()));
+
+    int steps = 0;
+    while (!is_goal_tiles(tiles.data(), cells)) {
+        const uint8_t wanted = static_cast<uint8_t>((value + kModulus - 1) % kModulus);
+        std::array<uint8_t, kRankMaxCells> next{};
+        int next_blank = -1;
+        for_each_move(t, type_, tiles.data(), blank, [&](int moved_blank) {
+            if (next_blank < 0 && value_at(ranker.rank(tiles.data())) == wanted) {
+                next = tiles;
+                next_blank = moved_blank;
+            }
+        });
+        if (next_blank < 0) {
+            return -1; // 表已损坏
+        }
+        tiles = next;
+        blank = next_blank;
+        value = wanted;
+        ++steps;
+    }
+    return steps;
+}
+
+std::vector<std::vector<std::vector<int>>> DistanceOracle::optimal_paths(const std::vector<int>& start, int max_paths) const {
+    const ShapeTables& t = shape_tables(rows_, cols_);
+    const BoardRanker ranker(rows_, cols_);
+    const int cells = rows_ * cols_;
+
+    std::array<uint8_t, kRankMaxCells> tiles{};
+    for (int pos = 0; pos < cells; ++pos) {
+        tiles[pos] = static_cast<uint8_t>(start[pos]);
+    }
+    std::vector<std::vector<std::vector<int>>> paths;
+    const int total = distance(tiles.data());
+    if (total < 0 || max_paths <= 0) {
+        return paths;
+    }
+
+    std::vector<std::vector<int>> path;
+    path.reserve(total + 1);
+    path.emplace_back(tiles.begin(), tiles.begin() + cells);
+
+    // 深度优先下降：每一步只走向余数为“剩余步数 - 1”的邻居，这些邻居的距离必然恰好少 1
+    auto descend = [&](auto&& self, int blank, int remaining) -> void {
+        if (remaining == 0) {
+            paths.push_back(path);
+            return;
+        }
+        const uint8_t wanted = static_cast<uint8_t>((remaining - 1) % kModulus);
+        for_each_move(t, type_, tiles.data(), blank, [&](int moved_blank) {
+            if (static_cast<int>(paths.size()) >= max_paths || value_at(ranker.rank(tiles.data())) != wanted) {
+                return;
+            }
+            path.emplace_back(tiles.begin(), tiles.begin() + cells);
+            self(self, moved_blank, remaining - 1);
+            path.pop_back();
+        });
+    };
+    descend(descend, find_blank(tiles.data(), cells), total);
+    return paths;
+}
@@ -0,0 +1,76 @@
+#ifndef DISTANCE_ORACLE_HPP
+#define DISTANCE_ORACLE_HPP
+
+#include "SolveType.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// 小棋盘（不超过 12 格）的完全距离表。
+// 可解状态按 BoardRanker 稠密排名，每个状态占 4 位，存放到目标状态的最少步数模 15，0xF 表示尚未访问（只在构造时出现）。
+// 每一步移动都可逆且代价为 1，相邻状态的距离至多相差 1，所以余数已足以在下降时认出“距离减 1”的邻居，
+// 完整的距离就是下降到目标状态所走的步数。3x4 的 239,500,800 个状态只需约 120 MB。
+//
+// 表由 oracle_builder 离线构造：从目标状态出发逐层并行 BFS（移动可逆，从目标出发的 BFS 即逆向 BFS），
+// 写成带文件头的二进制文件；求解时只以 mmap 只读映射已有文件，多个进程共享同一份页缓存。
+// 文件位于环境变量 NUMBER_SLIDER_ORACLE_DIR 指定的目录，未设置时为当前目录下的 oracles/。
+class DistanceOracle {
+public:
+    static constexpr int kMaxCells = 12;
+    static constexpr int kModulus = 15;
+    static constexpr uint8_t kUnvisited = 0xF;
+
+    // 行数、列数都不少于 2 且格子数不超过 kMaxCells 的形状
+    static bool supports(int rows, int cols);
+
+    // 某一形状与求解类型的距离表：映射已有文件，不构造；文件不存在或文件头不符时返回 nullptr。
+    // 进程内按 (rows, cols, type) 缓存，线程安全
+    static std::shared_ptr<const DistanceOracle> get(int rows, int cols, SolveType type);
+
+    // 只构造、不读写文件（3x4 每种求解类型约需一两分钟）；形状不受支持时返回 nullptr
+    static std::shared_ptr<DistanceOracle> build(int rows, int cols, SolveType type);
+
+    static std::string file_path(int rows, int cols, SolveType type);
+    bool write_file(const std::string& path) const;
+
+    DistanceOracle(const DistanceOracle&) = delete;
+    DistanceOracle& operator=(const DistanceOracle&) = delete;
+    ~DistanceOracle();
+
+    int rows() const { return rows_; }
+    int cols() const { return cols_; }
+    SolveType type() const { return type_; }
+    int max_distance() const { return max_distance_; } // 该形状下最难状态的步数
+
+    // tiles：按行优先排列的可解棋盘，0 为空格；返回到目标状态的最少步数
+    int distance(const uint8_t* tiles) const;
+
+    // 沿距离表下降，按方向顺序枚举至多 max_paths 条互不相同的最优路径。
+    // 每条路径为按行优先展开的棋盘序列，包含起始与目标状态；tiles 必须可解
+    std::vector<std::vector<std::vector<int>>> optimal_paths(const std::vector<int>& tiles, int max_paths) const;
+
+private:
+    DistanceOracle(int rows, int cols, SolveType type);
+
+    bool map_file(const std::string& path);
+    void build_table();
+
+    uint8_t value_at(uint64_t rank) const {
+        return static_cast<uint8_t>((table_[rank >> 1] >> ((rank & 1) * 4)) & 0xF);
+    }
+
+    int rows_;
+    int cols_;
+    SolveType type_;
+    uint64_t state_count_ = 0;
+    int max_distance_ = 0;
+
+    const uint8_t* table_ = nullptr; // 指向映射的文件或 owned_table_
+    std::vector<uint8_t> owned_table_; // 本进程刚构造的表
+    void* mapping_ = nullptr;
+    size_t mapping_size_ = 0;
+};
+
+#endif // DISTANCE_ORACLE_HPP
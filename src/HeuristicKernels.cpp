@@ -0,0 +1,296 @@
+#include "HeuristicKernels.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define NSS_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// 所有内核都按 16 位整数处理格子下标和数字。
+// 行号用乘法代替除法：对 0 <= x < 64、2 <= cols <= 64，x / cols == (x * (65536 / cols + 1)) >> 16。
+uint16_t division_magic(int cols) {
+    return static_cast<uint16_t>(65536 / cols + 1);
+}
+
+BoardEvaluation evaluate_scalar(const UnpackedTiles& tiles, int rows, int cols) {
+    BoardEvaluation result;
+    const int cells = rows * cols;
+    bool goal = true;
+    for (int pos = 0; pos < cells; ++pos) {
+        int tile = tiles[pos];
+        goal = goal && tile == (pos + 1 == cells ? 0 : pos + 1);
+        if (tile == 0) continue; // 空格不参与曼哈顿距离计算
+
+        int target = tile - 1;
+        int dr = pos / cols - target / cols;
+        int dc = pos % cols - target % cols;
+        result.manhattan += (dr < 0 ? -dr : dr) + (dc < 0 ? -dc : dc);
+        if (dr == 0) result.in_goal_row |= 1ULL << pos;
+        if (dc == 0) result.in_goal_col |= 1ULL << pos;
+    }
+    result.is_goal = goal;
+    return result;
+}
+
+void reduce_lanes_scalar(const uint8_t* values, int lanes, int* sums, int* maxima) {
+    for (int i = 0; i < lanes; ++i) {
+        int sum = 0;
+        int max = 0;
+        for (int j = 0; j < kKernelLaneWidth; ++j) {
+            sum += values[i * kKernelLaneWidth + j];
+            max = std::max(max, static_cast<int>(values[i * kKernelLaneWidth + j]));
+        }
+        sums[i] = sum;
+        maxima[i] = max;
+    }
+}
+
+#ifdef NSS_X86_KERNELS
+
+// 每个 64 位通道内：psadbw 对零求绝对差之和即字节和；字节最大值按 32、16、8 位三次移位折半，结果落在通道的最低字节
+__attribute__((target("sse2")))
+void reduce_lanes_sse2(const uint8_t* values, int lanes, int* sums, int* maxima) {
+    const __m128i zero = _mm_setzero_si128();
+    for (int i = 0; i < lanes; i += 2) {
+        const __m128i v = lanes - i >= 2 ? _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i * kKernelLaneWidth))
+                                         : _mm_loadl_epi64(reinterpret_cast<const __m128i*>(values + i * kKernelLaneWidth));
+        const __m128i sum = _mm_sad_epu8(v, zero);
+        __m128i max = _mm_max_epu8(v, _mm_srli_epi64(v, 32));
+        max = _mm_max_epu8(max, _mm_srli_epi64(max, 16));
+        max = _mm_max_epu8(max, _mm_srli_epi64(max, 8));
+        sums[i] = _mm_cvtsi128_si32(sum);
+        maxima[i] = _mm_cvtsi128_si32(max) & 0xFF;
+        if (lanes - i >= 2) {
+            sums[i + 1] = _mm_extract_epi16(sum, 4);
+            maxima[i + 1] = _mm_extract_epi16(max, 4) & 0xFF;
+        }
+    }
+}
+
+__attribute__((target("sse2")))
+BoardEvaluation evaluate_sse2(const UnpackedTiles& tiles, int rows, int cols) {
+    BoardEvaluation result;
+    const int cells = rows * cols;
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i magic = _mm_set1_epi16(static_cast<int16_t>(division_magic(cols)));
+    const __m128i width = _mm_set1_epi16(static_cast<int16_t>(cols));
+    const __m128i cell_count = _mm_set1_epi16(static_cast<int16_t>(cells));
+    const __m128i lane = _mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7);
+    __m128i sum = zero;
+    uint64_t mismatched = 0;
+
+    for (int base = 0; base < cells; base += 8) {
+        __m128i tile = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(tiles.data() + base)), zero);
+        __m128i pos = _mm_add_epi16(_mm_set1_epi16(static_cast<int16_t>(base)), lane);
+        __m128i in_board = _mm_cmplt_epi16(pos, cell_count);
+        __m128i valid = _mm_andnot_si128(_mm_cmpeq_epi16(tile, zero), in_board);
+
+        __m128i target = _mm_sub_epi16(tile, one);
+        __m128i goal_row = _mm_mulhi_epu16(target, magic);
+        __m128i goal_col = _mm_sub_epi16(target, _mm_mullo_epi16(goal_row, width));
+        __m128i row = _mm_mulhi_epu16(pos, magic);
+        __m128i col = _mm_sub_epi16(pos, _mm_mullo_epi16(row, width));
+
+        __m128i dr = _mm_max_epi16(_mm_sub_epi16(row, goal_row), _mm_sub_epi16(goal_row, row));
+        __m128i dc = _mm_max_epi16(_mm_sub_epi16(col, goal_col), _mm_sub_epi16(goal_col, col));
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_and_si128(_mm_add_epi16(dr, dc), valid), one));
+
+        __m128i row_hit = _mm_and_si128(_mm_cmpeq_epi16(row, goal_row), valid);
+        __m128i col_hit = _mm_and_si128(_mm_cmpeq_epi16(col, goal_col), valid);
+        result.in_goal_row |= static_cast<uint64_t>(_mm_movemask_epi8(_mm_packs_epi16(row_hit, zero))) << base;
+        result.in_goal_col |= static_cast<uint64_t>(_mm_movemask_epi8(_mm_packs_epi16(col_hit, zero))) << base;
+
+        // 目标状态：格子 pos 上是 pos + 1，最后一格是空格
+        __m128i next = _mm_add_epi16(pos, one);
+        __m128i expected = _mm_andnot_si128(_mm_cmpeq_epi16(next, cell_count), next);
+        __m128i wrong = _mm_andnot_si128(_mm_cmpeq_epi16(tile, expected), in_board);
+        mismatched |= static_cast<uint64_t>(_mm_movemask_epi8(wrong));
+    }
+
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    result.manhattan = _mm_cvtsi128_si32(sum);
+    result.is_goal = mismatched == 0;
+    return result;
+}
+
+// 同 reduce_lanes_sse2，一次四个通道，不足四个的余下部分交给 SSE2 版本
+__attribute__((target("avx2")))
+void reduce_lanes_avx2(const uint8_t* values, int lanes, int* sums, int* maxima) {
+    const __m256i zero = _mm256_setzero_si256();
+    int i = 0;
+    for (; lanes - i >= 4; i += 4) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i * kKernelLaneWidth));
+        const __m256i sum = _mm256_sad_epu8(v, zero);
+        __m256i max = _mm256_max_epu8(v, _mm256_srli_epi64(v, 32));
+        max = _mm256_max_epu8(max, _mm256_srli_epi64(max, 16));
+        max = _mm256_max_epu8(max, _mm256_srli_epi64(max, 8));
+        alignas(32) uint64_t sum_lanes[4];
+        alignas(32) uint64_t max_lanes[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(sum_lanes), sum);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(max_lanes), max);
+        for (int k = 0; k < 4; ++k) {
+            sums[i + k] = static_cast<int>(sum_lanes[k]);
+            maxima[i + k] = static_cast<int>(max_lanes[k] & 0xFF);
+        }
+    }
+    if (i < lanes) {
+        reduce_lanes_sse2(values + i * kKernelLaneWidth, lanes - i, sums + i, maxima + i);
+    }
+}
+
+// 16 位比较结果压缩成每格 1 位：packs 在两个 128 位半区内交错，需要再按 64 位重排
+__attribute__((target("avx2")))
+inline uint64_t lane_bits_avx2(__m256i mask16) {
+    __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi16(mask16, _mm256_setzero_si256()), _MM_SHUFFLE(3, 1, 2, 0));
+    return static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(packed)) & 0xFFFFu);
+}
+
+__attribute__((target("avx2")))
+BoardEvaluation evaluate_avx2(const UnpackedTiles& tiles, int rows, int cols) {
+    BoardEvaluation result;
+    const int cells = rows * cols;
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi16(1);
+    const __m256i magic = _mm256_set1_epi16(static_cast<int16_t>(division_magic(cols)));
+    const __m256i width = _mm256_set1_epi16(static_cast<int16_t>(cols));
+    const __m256i cell_count = _mm256_set1_epi16(static_cast<int16_t>(cells));
+    const __m256i lane = _mm256_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    __m256i sum = zero;
+    uint64_t mismatched = 0;
+
+    for (int base = 0; base < cells; base += 16) {
+        __m256i tile = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(tiles.data() + base)));
+        __m256i pos = _mm256_add_epi16(_mm256_set1_epi16(static_cast<int16_t>(base)), lane);
+        __m256i in_board = _mm256_cmpgt_epi16(cell_count, pos);
+        __m256i valid = _mm256_andnot_si256(_mm256_cmpeq_epi16(tile, zero), in_board);
+
+        __m256i target = _mm256_sub_epi16(tile, one);
+        __m256i goal_row = _mm256_mulhi_epu16(target, magic);
+        __m256i goal_col = _mm256_sub_epi16(target, _mm256_mullo_epi16(goal_row, width));
+        __m256i row = _mm256_mulhi_epu16(pos, magic);
+        __m256i col = _mm256_sub_epi16(pos, _mm256_mullo_epi16(row, width));
+
+        __m256i dist = _mm256_add_epi16(_mm256_abs_epi16(_mm256_sub_epi16(row, goal_row)),
+                                        _mm256_abs_epi16(_mm256_sub_epi16(col, goal_col)));
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_and_si256(dist, valid), one));
+
+        result.in_goal_row |= lane_bits_avx2(_mm256_and_si256(_mm256_cmpeq_epi16(row, goal_row), valid)) << base;
+        result.in_goal_col |= lane_bits_avx2(_mm256_and_si256(_mm256_cmpeq_epi16(col, goal_col), valid)) << base;
+
+        __m256i next = _mm256_add_epi16(pos, one);
+        __m256i expected = _mm256_andnot_si256(_mm256_cmpeq_epi16(next, cell_count), next);
+        mismatched |= lane_bits_avx2(_mm256_andnot_si256(_mm256_cmpeq_epi16(tile, expected), in_board));
+    }
+
+    __m128i folded = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    folded = _mm_add_epi32(folded, _mm_shuffle_epi32(folded, _MM_SHUFFLE(1, 0, 3, 2)));
+    folded = _mm_add_epi32(folded, _mm_shuffle_epi32(folded, _MM_SHUFFLE(2, 3, 0, 1)));
+    result.manhattan = _mm_cvtsi128_si32(folded);
+    result.is_goal = mismatched == 0;
+    return result;
+}
+
+__attribute__((target("avx512f,avx512bw")))
+BoardEvaluation evaluate_avx512bw(const UnpackedTiles& tiles, int rows, int cols) {
+    BoardEvaluation result;
+    const int cells = rows * cols;
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i one = _mm512_set1_epi16(1);
+    const __m512i magic = _mm512_set1_epi16(static_cast<int16_t>(division_magic(cols)));
+    const __m512i width = _mm512_set1_epi16(static_cast<int16_t>(cols));
+    const __m512i cell_count = _mm512_set1_epi16(static_cast<int16_t>(cells));
+    const __m512i lane = _mm512_set_epi16(31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16,
+                                          15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    __m512i sum = zero;
+    uint64_t mismatched = 0;
+
+    for (int base = 0; base < cells; base += 32) {
+        __m512i tile = _mm512_cvtepu8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(tiles.data() + base)));
+        __m512i pos = _mm512_add_epi16(_mm512_set1_epi16(static_cast<int16_t>(base)), lane);
+        __mmask32 in_board = _mm512_cmplt_epi16_mask(pos, cell_count);
+        __mmask32 valid = _mm512_mask_cmpneq_epi16_mask(in_board, tile, zero);
+
+        __m512i target = _mm512_sub_epi16(tile, one);
+        __m512i goal_row = _mm512_mulhi_epu16(target, magic);
+        __m512i goal_col = _mm512_sub_epi16(target, _mm512_mullo_epi16(goal_row, width));
+        __m512i row = _mm512_mulhi_epu16(pos, magic);
+        __m512i col = _mm512_sub_epi16(pos, _mm512_mullo_epi16(row, width));
+
+        __m512i dist = _mm512_maskz_add_epi16(valid, _mm512_abs_epi16(_mm512_sub_epi16(row, goal_row)),
+                                              _mm512_abs_epi16(_mm512_sub_epi16(col, goal_col)));
+        sum = _mm512_add_epi32(sum, _mm512_madd_epi16(dist, one));
+
+        result.in_goal_row |= static_cast<uint64_t>(_mm512_mask_cmpeq_epi16_mask(valid, row, goal_row)) << base;
+        result.in_goal_col |= static_cast<uint64_t>(_mm512_mask_cmpeq_epi16_mask(valid, col, goal_col)) << base;
+
+        __m512i next = _mm512_add_epi16(pos, one);
+        __m512i expected = _mm512_mask_mov_epi16(next, _mm512_cmpeq_epi16_mask(next, cell_count), zero);
+        mismatched |= _mm512_mask_cmpneq_epi16_mask(in_board, tile, expected);
+    }
+
+    alignas(64) int32_t partial[16];
+    _mm512_store_si512(partial, sum);
+    for (int32_t v : partial) {
+        result.manhattan += v;
+    }
+    result.is_goal = mismatched == 0;
+    return result;
+}
+
+#endif // NSS_X86_KERNELS
+
+using KernelFn = BoardEvaluation (*)(const UnpackedTiles&, int, int);
+using ReduceFn = void (*)(const uint8_t*, int, int*, int*);
+
+struct Kernel {
+    const char* name;
+    KernelFn fn;
+    ReduceFn reduce;
+};
+
+Kernel select_kernel() {
+    const char* forced = std::getenv("NUMBER_SLIDER_KERNEL");
+    auto allowed = [&](const char* name) { return forced == nullptr || std::strcmp(forced, name) == 0; };
+#ifdef NSS_X86_KERNELS
+    __builtin_cpu_init();
+    if (allowed("avx512bw") && __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+        return {"avx512bw", evaluate_avx512bw, reduce_lanes_avx2}; // 至多 8 个子节点，512 位寄存器填不满
+    }
+    if (allowed("avx2") && __builtin_cpu_supports("avx2")) {
+        return {"avx2", evaluate_avx2, reduce_lanes_avx2};
+    }
+    if (allowed("sse2") && __builtin_cpu_supports("sse2")) {
+        return {"sse2", evaluate_sse2, reduce_lanes_sse2};
+    }
+#endif
+    return {"scalar", evaluate_scalar, reduce_lanes_scalar};
+}
+
+const Kernel& active_kernel() {
+    static const Kernel kernel = select_kernel();
+    return kernel;
+}
+
+} // namespace
+
+BoardEvaluation evaluate_board(const UnpackedTiles& tiles, int rows, int cols) {
+    if (cols < 2) {
+        return evaluate_scalar(tiles, rows, cols);
+    }
+    return active_kernel().fn(tiles, rows, cols);
+}
+
+void reduce_lanes(const uint8_t* values, int lanes, int* sums, int* maxima) {
+    active_kernel().reduce(values, lanes, sums, maxima);
+}
+
+const char* heuristic_kernel_name() {
+    return active_kernel().name;
+}
@@ -0,0 +1,39 @@
+#ifndef HEURISTIC_KERNELS_HPP
+#define HEURISTIC_KERNELS_HPP
+
+#include <array>
+#include <cstdint>
+
+// 整盘从头评估与批量子节点归约的 SIMD 内核。
+// 搜索中子状态的启发值都是增量维护的，只有初始状态、模式数据库播种、批量校验等场景需要从头计算整盘，
+// 这些场景统一走这里。内核在程序启动后第一次调用时按 CPU 特性选择：AVX-512BW、AVX2、SSE2，
+// 非 x86 平台或 cols == 1 的退化棋盘使用标量实现，因此同一个可执行文件在不同机器上都能用到最快的指令集。
+// 设置环境变量 NUMBER_SLIDER_KERNEL=avx512bw|avx2|sse2|scalar 可强制指定内核（CPU 不支持时退回标量实现），便于对比。
+
+constexpr int kKernelMaxCells = 64;
+
+// 按行优先展开的棋盘数字，长度固定为 64，超出棋盘的部分必须为 0
+using UnpackedTiles = std::array<uint8_t, kKernelMaxCells>;
+
+struct BoardEvaluation {
+    int manhattan = 0;        // 曼哈顿距离之和（空格不计）
+    uint64_t in_goal_row = 0; // 第 i 位为 1：格子 i 上的数字已处于其目标行（线性冲突的前置条件）
+    uint64_t in_goal_col = 0; // 第 i 位为 1：格子 i 上的数字已处于其目标列
+    bool is_goal = false;     // 是否为目标状态 1, 2, ..., N*M-1, 0
+};
+
+// 用启动时选定的内核评估整盘
+BoardEvaluation evaluate_board(const UnpackedTiles& tiles, int rows, int cols);
+
+// 一批子节点的逐子节点归约：values 按子节点连续存放 lanes 个长度为 kKernelLaneWidth 的字节行（未使用的字节必须为 0），
+// sums[i] 与 maxima[i] 为第 i 行的和与最大值。模式数据库一次为同一父节点的所有子节点组合各模式的表值，
+// 一个 64 位通道对应一个子节点（SSE2 一次两个，AVX2 一次四个）。lanes 不超过 kKernelMaxLanes
+constexpr int kKernelLaneWidth = 8;
+constexpr int kKernelMaxLanes = 8;
+
+void reduce_lanes(const uint8_t* values, int lanes, int* sums, int* maxima);
+
+// 当前使用的内核名称（"avx512bw"、"avx2"、"sse2" 或 "scalar"），用于日志
+const char* heuristic_kernel_name();
+
+#endif // HEURISTIC_KERNELS_HPP
@@ -0,0 +1,186 @@
+#ifndef HEURISTIC_PIPELINE_HPP
+#define HEURISTIC_PIPELINE_HPP
+
+#include "Heuristics.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <string>
+#include <tuple>
+
+// 组合方式：各组件都是可采纳的下界时取最大值；组件之间互不重叠（如不相交的模式）时可以相加
+struct MaxCombine {
+    static constexpr const char* kName = "max";
+    static int apply(int h, int value) { return h > value ? h : value; }
+};
+
+struct AddCombine {
+    static constexpr const char* kName = "add";
+    static int apply(int h, int value) { return h + value; }
+};
+
+// 各组件的命中与开销计数，搜索结束后据此为不同棋盘形状挑选组件组合。
+// 每个线程每 64 批子节点抽样一批，只统计抽样的子节点，其余不做原子操作
+struct PipelineStats {
+    static constexpr int kMaxComponents = 4;
+
+    struct Component {
+        std::atomic<long long> evaluations{0};
+        std::atomic<long long> skipped{0};     // 前面的组件已证明子节点会被剪枝，未计算
+        std::atomic<long long> pruned{0};      // 计算到该组件时组合值首次超过剪枝上限
+        std::atomic<long long> raised{0};      // 该组件严格抬高了前面组件的组合值
+        std::atomic<long long> nanoseconds{0}; // 各次计算的总耗时
+    };
+
+    std::atomic<long long> nodes{0}; // 抽样的子节点数
+    std::array<Component, kMaxComponents> components;
+};
+
+// 编译期组合的启发函数流水线：Components 按开销从低到高排列，依次计算并按 Combine 组合。
+// 每个组件各自增量维护 NodeData。IDA* 给出剪枝上限时，一旦组合值已超过上限（子节点一定被剪枝），
+// 后面较贵的组件（通常是模式数据库查表）就不再计算，它们在子节点数据中标记为无效；
+// 这样的子节点不会被扩展，万一用作父节点时无效的组件由 init 从头计算。
+// 跳过组件时返回的 h 偏小但仍大于上限，只可能让 IDA* 的下一轮阈值偏小，不影响最优性。
+// 同一父节点的一批子节点逐个组件地计算，每个组件只算仍未超过上限的子节点。
+// 每个组件的计算、跳过、剪枝命中与抬高次数以及计算耗时按批抽样计入 PipelineStats。
+template <typename Combine, typename... Components>
+struct HeuristicPipeline {
+    static_assert(sizeof...(Components) >= 1 && sizeof...(Components) <= PipelineStats::kMaxComponents,
+                  "a pipeline has 1 to PipelineStats::kMaxComponents components");
+
+    static constexpr const char* kName = "pipeline";
+    static constexpr bool kBounded = true;
+    static constexpr bool kBatched = true;
+    static constexpr int kCost = std::max({Components::kCost...});
+    static constexpr std::array<const char*, sizeof...(Components)> kComponentNames{Components::kName...};
+    static constexpr uint32_t kSampleMask = 0x3F;
+
+    static constexpr bool cost_ordered() {
+        constexpr std::array<int, sizeof...(Components)> costs{Components::kCost...};
+        for (size_t i = 1; i < costs.size(); ++i) {
+            if (costs[i] < costs[i - 1]) {
+                return false;
+            }
+        }
+        return true;
+    }
+    static_assert(cost_ordered(), "pipeline components must be listed from cheapest to most expensive");
+
+    struct NodeData {
+        std::tuple<typename Components::NodeData...> parts;
+        uint8_t valid = 0; // 第 i 位：parts 中第 i 个组件的数据是当前的
+    };
+
+    std::tuple<Components...> components;
+    std::shared_ptr<PipelineStats> stats = std::make_shared<PipelineStats>();
+
+    explicit HeuristicPipeline(Components... parts) : components(std::move(parts)...) {}
+
+    // 如 "max(linear-conflict, pattern-database)"
+    static std::string describe() {
+        std::string text = std::string(Combine::kName) + "(";
+        for (size_t i = 0; i < kComponentNames.size(); ++i) {
+            text += (i == 0 ? "" : ", ") + std::string(kComponentNames[i]);
+        }
+        return text + ")";
+    }
+
+    template <typename BoardT>
+    int init(const BoardT& board, int manhattan, NodeData& data) const {
+        int h = 0;
+        init_from<0>(board, manhattan, data, h);
+        data.valid = static_cast<uint8_t>((1u << sizeof...(Components)) - 1);
+        return h;
+    }
+
+    template <typename BoardT>
+    int child(const BoardT& parent, const NodeData& parent_data, const BoardT& child, int child_manhattan, NodeData& child_data,
+              int limit = std::numeric_limits<int>::max()) const {
+        ChildSlot<BoardT, NodeData> slot{&child, child_manhattan, &child_data, 0};
+        children(parent, parent_data, &slot, 1, limit);
+        return slot.h;
+    }
+
+    // 各组件依次对仍未超过 limit 的子节点批量计算（组件本身支持批量时交错查表）
+    template <typename BoardT>
+    void children(const BoardT& parent, const NodeData& parent_data, ChildSlot<BoardT, NodeData>* slots, int count, int limit) const {
+        static thread_local uint32_t tick = 0;
+        const bool sampled = (++tick & kSampleMask) == 0;
+        if (sampled) {
+            stats->nodes.fetch_add(count, std::memory_order_relaxed);
+        }
+        for (int c = 0; c < count; ++c) {
+            slots[c].h = 0;
+            slots[c].data->valid = 0;
+        }
+        children_from<0>(parent, parent_data, slots, count, limit, sampled);
+    }
+
+private:
+    template <size_t I, typename BoardT>
+    void init_from(const BoardT& board, int manhattan, NodeData& data, int& h) const {
+        if constexpr (I < sizeof...(Components)) {
+            const int value = std::get<I>(components).init(board, manhattan, std::get<I>(data.parts));
+            h = I == 0 ? value : Combine::apply(h, value);
+            init_from<I + 1>(board, manhattan, data, h);
+        }
+    }
+
+    template <size_t I, typename BoardT>
+    void children_from(const BoardT& parent, const NodeData& parent_data, ChildSlot<BoardT, NodeData>* slots, int count, int limit,
+                       bool sampled) const {
+        if constexpr (I < sizeof...(Components)) {
+            using Component = std::tuple_element_t<I, std::tuple<Components...>>;
+            PipelineStats::Component& counters = stats->components[I];
+            std::array<ChildSlot<BoardT, typename Component::NodeData>, kMaxChildBatch> parts;
+            std::array<int, kMaxChildBatch> owners;
+            int active = 0;
+            for (int c = 0; c < count; ++c) {
+                if (I > 0 && slots[c].h > limit) {
+                    continue;
+                }
+                parts[active] = {slots[c].board, slots[c].manhattan, &std::get<I>(slots[c].data->parts), 0};
+                owners[active++] = c;
+            }
+            if (sampled) {
+                counters.skipped.fetch_add(count - active, std::memory_order_relaxed);
+            }
+            if (active > 0) {
+                const auto start = sampled ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+                const Component& component = std::get<I>(components);
+                if ((parent_data.valid >> I) & 1u) {
+                    evaluate_children(component, parent, std::get<I>(parent_data.parts), parts.data(), active, limit);
+                } else {
+                    for (int a = 0; a < active; ++a) {
+                        parts[a].h = component.init(*parts[a].board, parts[a].manhattan, *parts[a].data);
+                    }
+                }
+                if (sampled) {
+                    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+                    counters.nanoseconds.fetch_add(elapsed.count(), std::memory_order_relaxed);
+                    counters.evaluations.fetch_add(active, std::memory_order_relaxed);
+                }
+                for (int a = 0; a < active; ++a) {
+                    ChildSlot<BoardT, NodeData>& slot = slots[owners[a]];
+                    slot.data->valid |= static_cast<uint8_t>(1u << I);
+                    const int combined = I == 0 ? parts[a].h : Combine::apply(slot.h, parts[a].h);
+                    if (sampled) {
+                        if (I > 0 && combined > slot.h) {
+                            counters.raised.fetch_add(1, std::memory_order_relaxed);
+                        }
+                        if (combined > limit) { // 走到这里时前面的组合值还没有超过上限
+                            counters.pruned.fetch_add(1, std::memory_order_relaxed);
+                        }
+                    }
+                    slot.h = combined;
+                }
+            }
+            children_from<I + 1>(parent, parent_data, slots, count, limit, sampled);
+        }
+    }
+};
+
+#endif // HEURISTIC_PIPELINE_HPP
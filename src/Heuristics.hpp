@@ -0,0 +1,702 @@
+#ifndef HEURISTICS_HPP
+#define HEURISTICS_HPP
+
+#include "HeuristicKernels.hpp"
+#include "PatternDatabase.hpp"
+#include "ShapeTables.hpp"
+#include "WalkingDistance.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// 搜索使用的启发函数策略。
+// 每个策略是一个轻量对象，搜索引擎以模板参数持有它，热循环中的调用全部内联：
+//   NodeData                       —— 随搜索节点保存的增量数据
+//   init(board, manhattan, data)   —— 从头计算根节点，返回 h 并填写 data
+//   child(parent, parent_data, child, child_manhattan, child_data)
+//                                  —— 由父节点增量得到子节点，返回 h 并填写 child_data
+// 曼哈顿距离总是由棋盘的邻居枚举函数增量维护并传入，策略只负责在其上叠加的部分。
+// kCost 为每个节点的相对开销等级，HeuristicPipeline 据此检查组件按开销从低到高排列。
+//
+// 可选：kBounded 为 true 的策略另外提供 child(..., limit)。子节点的 h 大于 limit 时该子节点一定被剪枝，
+// 策略可以只算出一个同样大于 limit 的较小下界就返回；IDA* 以 limit = 阈值 - 子节点的 g 调用。
+// 可选：kBatched 为 true 的策略提供 children(parent, parent_data, slots, count, limit)，一次计算同一父节点的
+// 至多 kMaxChildBatch 个子节点（见 ChildSlot），可以把各子节点的查表交错进行；搜索引擎统一经 evaluate_children 调用。
+
+constexpr int kMaxChildBatch = 8;
+static_assert(kMaxChildBatch <= kKernelMaxLanes, "a child batch must fit in one reduce_lanes call");
+
+// 批量计算时的一个子节点：board 与 manhattan 为输入，data 与 h 为输出；不带默认初始化，批数组不必逐项清零
+template <typename BoardT, typename NodeData>
+struct ChildSlot {
+    const BoardT* board;
+    int manhattan;
+    NodeData* data;
+    int h;
+};
+
+// 仅曼哈顿距离
+struct ManhattanHeuristic {
+    static constexpr const char* kName = "manhattan";
+    static constexpr int kCost = 0;
+
+    struct NodeData {};
+
+    template <typename BoardT>
+    int init(const BoardT&, int manhattan, NodeData&) const {
+        return manhattan;
+    }
+
+    template <typename BoardT>
+    int child(const BoardT&, const NodeData&, const BoardT&, int child_manhattan, NodeData&) const {
+        return child_manhattan;
+    }
+};
+
+// 最长严格递增子序列的长度，keys 为同一条线上各数字的目标列（或目标行）
+inline int longest_increasing_subsequence(const uint8_t* keys, int count) {
+    std::array<uint8_t, 64> tails{};
+    int length = 0;
+    for (int i = 0; i < count; ++i) {
+        int pos = static_cast<int>(std::lower_bound(tails.begin(), tails.begin() + length, keys[i]) - tails.begin());
+        tails[pos] = keys[i];
+        length += (pos == length);
+    }
+    return length;
+}
+
+// 曼哈顿距离 + 线性冲突。
+// 一行中已处于目标行的 k 个数字若按目标列的顺序有逆序，至少要有 k - LIS 个数字暂时离开这一行再回来，
+// 每个多走 2 步（LIS 为按目标列的最长递增子序列）；列同理。这些步是曼哈顿距离之外的竖直（水平）移动，
+// 行与列的附加值可以与曼哈顿距离相加而保持可采纳。
+// 按对计数的 “每对逆序 +2” 在三个以上数字互相冲突时会高估，这里用 2 * (k - LIS) 代替。
+// 一次移动只改变被移动数字所在的行（竖直移动）或列（水平移动），增量更新时只重算空格移动经过的线。
+struct LinearConflictHeuristic {
+    static constexpr const char* kName = "linear-conflict";
+    static constexpr int kCost = 1;
+
+    struct NodeData {
+        int conflicts = 0; // 所有行与列的附加步数之和
+    };
+
+    template <typename BoardT>
+    static int row_conflicts(const BoardT& board, int row) {
+        const int cols = board.cols();
+        std::array<uint8_t, 64> keys{};
+        int count = 0;
+        for (int c = 0; c < cols; ++c) {
+            int tile = board.at(row * cols + c);
+            if (tile != 0 && (tile - 1) / cols == row) {
+                keys[count++] = static_cast<uint8_t>((tile - 1) % cols);
+            }
+        }
+        return 2 * (count - longest_increasing_subsequence(keys.data(), count));
+    }
+
+    template <typename BoardT>
+    static int col_conflicts(const BoardT& board, int col) {
+        const int rows = board.rows();
+        const int cols = board.cols();
+        std::array<uint8_t, 64> keys{};
+        int count = 0;
+        for (int r = 0; r < rows; ++r) {
+            int tile = board.at(r * cols + col);
+            if (tile != 0 && (tile - 1) % cols == col) {
+                keys[count++] = static_cast<uint8_t>((tile - 1) / cols);
+            }
+        }
+        return 2 * (count - longest_increasing_subsequence(keys.data(), count));
+    }
+
+    template <typename BoardT>
+    int init(const BoardT& board, int manhattan, NodeData& data) const {
+        data.conflicts = 0;
+        for (int r = 0; r < board.rows(); ++r) data.conflicts += row_conflicts(board, r);
+        for (int c = 0; c < board.cols(); ++c) data.conflicts += col_conflicts(board, c);
+        return manhattan + data.conflicts;
+    }
+
+    // 竖直移动只改变空格经过的各行，水平移动只改变空格经过的各列；
+    // 批量位移时空格经过多行（多列），相邻交换时恰为两行（两列）
+    template <typename BoardT>
+    int child(const BoardT& parent, const NodeData& parent_data, const BoardT& child, int child_manhattan, NodeData& child_data) const {
+        const int cols = parent.cols();
+        const int from_row = parent.blank / cols;
+        const int from_col = parent.blank % cols;
+        const int to_row = child.blank / cols;
+        const int to_col = child.blank % cols;
+        int conflicts = parent_data.conflicts;
+        if (from_col == to_col) {
+            for (int r = std::min(from_row, to_row); r <= std::max(from_row, to_row); ++r) {
+                conflicts += row_conflicts(child, r) - row_conflicts(parent, r);
+            }
+        } else {
+            for (int c = std::min(from_col, to_col); c <= std::max(from_col, to_col); ++c) {
+                conflicts += col_conflicts(child, c) - col_conflicts(parent, c);
+            }
+        }
+        child_data.conflicts = conflicts;
+        return child_manhattan + conflicts;
+    }
+};
+
+// Walking Distance：行表与列表的距离之和（见 WalkingDistance.hpp），NodeData 保存两张表中的状态编号，
+// 每一步移动按被移动数字的目标行（列）查转移表更新。两者不可相加，可选地与曼哈顿距离 + 线性冲突取最大值。
+// 逆排列的 WD 不单独提供：逆排列的计数矩阵是原矩阵的转置，而 WD 在转置下不变，取最大值不会改变结果。
+struct WalkingDistanceHeuristic {
+    static constexpr const char* kName = "walking-distance";
+    static constexpr int kCost = 2;
+
+    struct NodeData {
+        int32_t row_state = WalkingDistanceTable::kInvalid;
+        int32_t col_state = WalkingDistanceTable::kInvalid;
+        LinearConflictHeuristic::NodeData linear_conflict;
+    };
+
+    std::shared_ptr<const WalkingDistanceTable> row_table; // N 条线，每条 M 格
+    std::shared_ptr<const WalkingDistanceTable> col_table; // M 条线，每条 N 格
+    bool max_with_linear_conflict = false;
+
+    WalkingDistanceHeuristic(int rows, int cols, bool linear_conflict) :
+        row_table(WalkingDistanceTable::get(rows, cols)), col_table(WalkingDistanceTable::get(cols, rows)),
+        max_with_linear_conflict(linear_conflict) {}
+
+    // 两张表都能生成时才可用
+    bool supported() const { return row_table != nullptr && col_table != nullptr; }
+
+    template <typename BoardT>
+    int init(const BoardT& board, int manhattan, NodeData& data) const {
+        const int rows = board.rows();
+        const int cols = board.cols();
+        std::vector<uint8_t> row_counts(rows * rows, 0);
+        std::vector<uint8_t> col_counts(cols * cols, 0);
+        for (int pos = 0; pos < rows * cols; ++pos) {
+            int tile = board.at(pos);
+            if (tile != 0) {
+                ++row_counts[(pos / cols) * rows + (tile - 1) / cols];
+                ++col_counts[(pos % cols) * cols + (tile - 1) % cols];
+            }
+        }
+        data.row_state = row_table->index_of(row_counts, board.blank / cols);
+        data.col_state = col_table->index_of(col_counts, board.blank % cols);
+        if (max_with_linear_conflict) {
+            LinearConflictHeuristic().init(board, manhattan, data.linear_conflict);
+        }
+        return evaluate(manhattan, data);
+    }
+
+    // 空格从父节点的位置逐格走到子节点的位置，每走一格，原来在下一格的数字移入空格原来的位置
+    template <typename BoardT>
+    int child(const BoardT& parent, const NodeData& parent_data, const BoardT& child, int child_manhattan, NodeData& child_data) const {
+        const int cols = parent.cols();
+        const bool vertical = parent.blank % cols == child.blank % cols;
+        const bool backward = child.blank < parent.blank; // 空格向上（向左）
+        const int step = (vertical ? cols : 1) * (backward ? -1 : 1);
+        child_data = parent_data;
+        for (int pos = parent.blank; pos != child.blank; pos += step) {
+            int tile = child.at(pos);
+            if (vertical) {
+                child_data.row_state = row_table->next(child_data.row_state, backward, (tile - 1) / cols);
+            } else {
+                child_data.col_state = col_table->next(child_data.col_state, backward, (tile - 1) % cols);
+            }
+        }
+        if (max_with_linear_conflict) {
+            LinearConflictHeuristic().child(parent, parent_data.linear_conflict, child, child_manhattan, child_data.linear_conflict);
+        }
+        return evaluate(child_manhattan, child_data);
+    }
+
+    int evaluate(int manhattan, const NodeData& data) const {
+        int h = row_table->distance(data.row_state) + col_table->distance(data.col_state);
+        if (max_with_linear_conflict) {
+            h = std::max(h, manhattan + data.linear_conflict.conflicts);
+        }
+        return h;
+    }
+};
+
+// 批量位移计分下的行列穿越下界。
+// 批量位移一次可以推动一整串数字，曼哈顿距离及在它之上叠加的启发函数都会高估。
+// 对每条行分界线 b（第 b 行与第 b+1 行之间），当前行与目标行分处两侧的数字都至少要越过它一次；
+// 一次竖直位移推动的是同一列中连续的一串数字，每个各移动一行，所以每条分界线至多被其中一个数字越过，
+// 竖直位移次数不少于各行分界线上这类数字个数的最大值。水平位移与列分界线同理，两类位移互不重叠，两者相加仍是可采纳的下界。
+// 相邻交换下它不超过曼哈顿距离。NodeData 保存每条分界线上的个数，一次位移中每个被推动的数字恰好越过一条分界线，增量更新。
+struct BlockCrossingHeuristic {
+    static constexpr const char* kName = "block-crossing";
+    static constexpr int kCost = 1;
+    // 输入只要求行列为正，1xN 与 Nx1 的棋盘也会用到；至多 ShapeTables::kMaxCells 格时每个方向的分界线少于 kMaxCells 条
+    static constexpr int kMaxLines = ShapeTables::kMaxCells;
+
+    struct NodeData {
+        std::array<uint8_t, kMaxLines> row_crossings{}; // [b]：需要越过第 b 条行分界线的数字个数
+        std::array<uint8_t, kMaxLines> col_crossings{};
+    };
+
+    template <typename BoardT>
+    int init(const BoardT& board, int, NodeData& data) const {
+        const int cols = board.cols();
+        data = NodeData{};
+        for (int pos = 0; pos < board.size(); ++pos) {
+            int tile = board.at(pos);
+            if (tile == 0) {
+                continue;
+            }
+            const int row = pos / cols;
+            const int goal_row = (tile - 1) / cols;
+            for (int b = std::min(row, goal_row); b < std::max(row, goal_row); ++b) {
+                ++data.row_crossings[b];
+            }
+            const int col = pos % cols;
+            const int goal_col = (tile - 1) % cols;
+            for (int b = std::min(col, goal_col); b < std::max(col, goal_col); ++b) {
+                ++data.col_crossings[b];
+            }
+        }
+        return evaluate(data);
+    }
+
+    // 空格从父节点的位置走到子节点的位置，经过的每一格上的数字来自它的下一格，越过两格之间的分界线
+    template <typename BoardT>
+    int child(const BoardT& parent, const NodeData& parent_data, const BoardT& child, int, NodeData& child_data) const {
+        const int cols = parent.cols();
+        const bool vertical = parent.blank % cols == child.blank % cols;
+        const int step = (vertical ? cols : 1) * (child.blank < parent.blank ? -1 : 1);
+        child_data = parent_data;
+        std::array<uint8_t, kMaxLines>& crossings = vertical ? child_data.row_crossings : child_data.col_crossings;
+        for (int pos = parent.blank; pos != child.blank; pos += step) {
+            const int tile = child.at(pos);
+            const int to = vertical ? pos / cols : pos % cols;
+            const int from = vertical ? (pos + step) / cols : (pos + step) % cols;
+            const int goal = vertical ? (tile - 1) / cols : (tile - 1) % cols;
+            const int b = std::min(from, to);
+            // 目标在移入的一侧时不再需要越过这条分界线，否则多出一次
+            if ((to > from) == (goal > b)) {
+                --crossings[b];
+            } else {
+                ++crossings[b];
+            }
+        }
+        return evaluate(child_data);
+    }
+
+    // 超出棋盘的分界线计数恒为 0，按定长数组取最大值，编译器可以向量化
+    static int evaluate(const NodeData& data) {
+        uint8_t rows = 0;
+        uint8_t cols = 0;
+        for (int b = 0; b < kMaxLines; ++b) {
+            rows = std::max(rows, data.row_crossings[b]);
+            cols = std::max(cols, data.col_crossings[b]);
+        }
+        return rows + cols;
+    }
+};
+
+// 加性不相交模式数据库：各模式表值之和（见 PatternDatabase.hpp）。
+// 批量位移计分下的表（按批量位移构造）不可相加，取各模式表值的最大值。
+// NodeData 保存每个模式的表值；一次移动只改变被移动数字所属模式的表值，子节点只重新查这些模式。
+//
+// 同一组表还能给出另外两个可采纳的下界，取三者的最大值：
+// - 反射（仅方形棋盘）：把棋盘沿主对角线转置，并把数字换成转置后目标位置上的数字，得到的局面与原局面步数相同。
+//   反射局面中模式数字 t 的位置就是原局面中数字 reflect(t) 位置的转置，同样按模式增量维护。
+// - 对偶：把局面看作 位置 -> 数字 的排列，对偶局面是它的逆排列，数字 t 在对偶局面中的位置是原局面格子 t-1 上的数字。
+//   空格在目标格时对偶局面与原局面步数相同，否则不成立，所以先把空格沿固定路线（先向右到最后一列，再向下）移回目标格，
+//   用移回后局面的对偶表值减去路线长度（批量位移下路线至多 2 次位移）。空格沿这条路线的树边移动（同一行内，或最后一列内）时移回后的局面不变，
+//   直接沿用父节点的对偶表值，只有其余的竖直移动需要重新查全部模式。
+struct PatternDatabaseHeuristic {
+    static constexpr const char* kName = "pattern-database";
+    static constexpr int kCost = 3;
+    static constexpr bool kBatched = true;
+    static constexpr int kMaxGroups = 8;
+    static_assert(kMaxGroups == kKernelLaneWidth, "each child's pattern values fill one reduce_lanes lane");
+
+    struct NodeData {
+        std::array<uint8_t, kMaxGroups> values{};
+        std::array<uint8_t, kMaxGroups> reflected{}; // 反射局面中各模式的表值
+        uint8_t dual_home = 0;                       // 空格移回目标格后，对偶局面各模式表值的组合
+    };
+
+    // 反射与对偶查表的开销和收益，启用任一种时才统计。
+    // 与 PipelineStats 相同，每个线程每 64 次计算（批量时为每 64 批）抽样一次，只统计抽样的节点，其余不做原子操作
+    static constexpr uint32_t kSampleMask = 0x3F;
+
+    struct Stats {
+        std::atomic<long long> nodes{0};             // 抽样的节点数
+        std::atomic<long long> lookups{0};           // 常规查表次数
+        std::atomic<long long> reflected_lookups{0};
+        std::atomic<long long> dual_lookups{0};
+        std::atomic<long long> dual_reused{0};       // 沿用父节点对偶表值的节点数
+        std::atomic<long long> reflected_raised{0};  // 反射值严格大于常规值的节点数
+        std::atomic<long long> dual_raised{0};       // 对偶值严格大于前两者的节点数
+    };
+
+    std::vector<std::shared_ptr<const PatternDatabase>> databases;
+    std::array<int8_t, 64> group_of{};       // 数字 -> 所属模式，-1 表示不属于任何模式
+    std::array<uint8_t, 64> index_in_group{}; // 数字 -> 在所属模式中的下标
+    bool additive = true; // 相邻交换的表相加，批量位移的表取最大值
+    bool reflect = false;
+    bool dual = false;
+    std::array<int8_t, 64> reflected_group_of{};       // 原局面的数字 s -> reflect(s) 所属模式
+    std::array<uint8_t, 64> reflected_index_in_group{};
+    std::array<uint8_t, 64> transposed{};              // 格子 -> 转置后的格子
+    std::shared_ptr<Stats> stats;
+
+    // reflect 只对方形棋盘有意义，由调用方保证
+    explicit PatternDatabaseHeuristic(std::vector<std::shared_ptr<const PatternDatabase>> groups, bool use_reflection = false,
+                                      bool use_dual = false)
+        : databases(std::move(groups)), reflect(use_reflection), dual(use_dual) {
+        additive = databases.empty() || databases[0]->type() == SolveType::AdjacentSwap;
+        group_of.fill(-1);
+        for (size_t g = 0; g < databases.size(); ++g) {
+            const std::vector<int>& tiles = databases[g]->tiles();
+            for (size_t i = 0; i < tiles.size(); ++i) {
+                group_of[tiles[i]] = static_cast<int8_t>(g);
+                index_in_group[tiles[i]] = static_cast<uint8_t>(i);
+            }
+        }
+        const int n = databases.empty() ? 0 : databases[0]->rows();
+        reflected_group_of.fill(-1);
+        for (int pos = 0; reflect && pos < n * n; ++pos) {
+            transposed[pos] = static_cast<uint8_t>(pos % n * n + pos / n);
+            const int tile = pos + 1;
+            const int source = transposed[pos] + 1; // reflect(tile)，空格的目标格转置后不变
+            if (tile < n * n) {
+                reflected_group_of[source] = group_of[tile];
+                reflected_index_in_group[source] = index_in_group[tile];
+            }
+        }
+        if (reflect || dual) {
+            stats = std::make_shared<Stats>();
+        }
+    }
+
+    // 本次计算是否计入 stats
+    bool sample() const {
+        static thread_local uint32_t tick = 0;
+        return stats && (++tick & kSampleMask) == 0;
+    }
+
+    template <typename BoardT>
+    void positions_of(const BoardT& board, int group, uint8_t* positions) const {
+        for (int pos = 0; pos < board.size(); ++pos) {
+            int tile = board.at(pos);
+            if (group_of[tile] == group) {
+                positions[index_in_group[tile]] = static_cast<uint8_t>(pos);
+            }
+        }
+    }
+
+    template <typename BoardT>
+    void reflected_positions_of(const BoardT& board, int group, uint8_t* positions) const {
+        for (int pos = 0; pos < board.size(); ++pos) {
+            int tile = board.at(pos);
+            if (reflected_group_of[tile] == group) {
+                positions[reflected_index_in_group[tile]] = transposed[pos];
+            }
+        }
+    }
+
+    template <typename BoardT>
+    int lookup(const BoardT& board, int group) const {
+        std::array<uint8_t, 64> positions{};
+        positions_of(board, group, positions.data());
+        return databases[group]->lookup(positions.data());
+    }
+
+    template <typename BoardT>
+    int lookup_reflected(const BoardT& board, int group) const {
+        std::array<uint8_t, 64> positions{};
+        reflected_positions_of(board, group, positions.data());
+        return databases[group]->lookup(positions.data());
+    }
+
+    // 空格先向右、再向下移回目标格后的局面，其对偶局面在各模式中的表项（probes[g] 对应模式 g）
+    template <typename BoardT>
+    void dual_home_probes(const BoardT& board, PatternDatabase::Probe* probes) const {
+        const int cells = board.size();
+        const int cols = board.cols();
+        std::array<uint8_t, 64> tiles{};
+        for (int pos = 0; pos < cells; ++pos) {
+            tiles[pos] = static_cast<uint8_t>(board.at(pos));
+        }
+        int blank = board.blank;
+        for (; blank % cols != cols - 1; ++blank) {
+            tiles[blank] = tiles[blank + 1];
+        }
+        for (; blank + cols < cells; blank += cols) {
+            tiles[blank] = tiles[blank + cols];
+        }
+        tiles[blank] = 0;
+        std::array<uint8_t, 64> positions{};
+        for (size_t g = 0; g < databases.size(); ++g) {
+            const std::vector<int>& group = databases[g]->tiles();
+            for (size_t i = 0; i < group.size(); ++i) {
+                const int element = tiles[group[i] - 1];
+                positions[i] = static_cast<uint8_t>(element == 0 ? cells - 1 : element - 1);
+            }
+            probes[g] = databases[g]->probe(positions.data());
+        }
+    }
+
+    // 各模式表值按 combine 组合
+    template <typename BoardT>
+    int lookup_dual_home(const BoardT& board) const {
+        std::array<PatternDatabase::Probe, kMaxGroups> probes;
+        dual_home_probes(board, probes.data());
+        std::array<uint8_t, kMaxGroups> values{};
+        for (size_t g = 0; g < databases.size(); ++g) {
+            values[g] = static_cast<uint8_t>(databases[g]->value(probes[g]));
+        }
+        return combine(values);
+    }
+
+    // 未使用的模式表值恒为 0，按定长数组求和或取最大值，编译器可以向量化
+    int combine(const std::array<uint8_t, kMaxGroups>& values) const {
+        int sum = 0;
+        uint8_t max = 0;
+        for (int g = 0; g < kMaxGroups; ++g) {
+            sum += values[g];
+            max = std::max(max, values[g]);
+        }
+        return additive ? sum : max;
+    }
+
+    template <typename BoardT>
+    int evaluate(const BoardT& board, const NodeData& data, bool sampled) const {
+        return evaluate_combined(board, combine(data.values), reflect ? combine(data.reflected) : 0, data.dual_home, sampled);
+    }
+
+    // regular、reflected 为已组合的常规与反射表值
+    template <typename BoardT>
+    int evaluate_combined(const BoardT& board, int regular, int reflected, int dual_home, bool sampled) const {
+        if (!reflect && !dual) {
+            return regular;
+        }
+        int h = regular;
+        if (reflect) {
+            if (reflected > h) {
+                h = reflected;
+                if (sampled) {
+                    stats->reflected_raised.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        }
+        if (dual) {
+            const int right = board.cols() - 1 - board.blank % board.cols();
+            const int down = board.rows() - 1 - board.blank / board.cols();
+            const int home_distance = additive ? right + down : (right > 0) + (down > 0);
+            const int dual_value = dual_home - home_distance;
+            if (dual_value > h) {
+                h = dual_value;
+                if (sampled) {
+                    stats->dual_raised.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        }
+        if (sampled) {
+            stats->nodes.fetch_add(1, std::memory_order_relaxed);
+        }
+        return h;
+    }
+
+    template <typename BoardT>
+    int init(const BoardT& board, int, NodeData& data) const {
+        for (size_t g = 0; g < databases.size(); ++g) {
+            data.values[g] = static_cast<uint8_t>(lookup(board, static_cast<int>(g)));
+            if (reflect) {
+                data.reflected[g] = static_cast<uint8_t>(lookup_reflected(board, static_cast<int>(g)));
+            }
+        }
+        if (dual) {
+            data.dual_home = static_cast<uint8_t>(lookup_dual_home(board));
+        }
+        return evaluate(board, data, false); // init 不经过 moved_groups，不计入按节点的查表统计
+    }
+
+    // 空格从父节点的位置走到子节点的位置，经过的格子上现在是被移动的数字，只需重新查这些数字所属的模式
+    template <typename BoardT>
+    void moved_groups(const BoardT& parent, const BoardT& child, unsigned& affected, unsigned& reflected_affected, bool sampled) const {
+        const int cols = parent.cols();
+        const int step = (parent.blank % cols == child.blank % cols ? cols : 1) * (child.blank < parent.blank ? -1 : 1);
+        affected = 0;
+        reflected_affected = 0;
+        for (int pos = parent.blank; pos != child.blank; pos += step) {
+            int group = group_of[child.at(pos)];
+            if (group >= 0) {
+                affected |= 1u << group;
+            }
+            int reflected_group = reflected_group_of[child.at(pos)];
+            if (reflected_group >= 0) {
+                reflected_affected |= 1u << reflected_group;
+            }
+        }
+        if (sampled) {
+            stats->lookups.fetch_add(__builtin_popcount(affected), std::memory_order_relaxed);
+            stats->reflected_lookups.fetch_add(__builtin_popcount(reflected_affected), std::memory_order_relaxed);
+        }
+    }
+
+    // 同一行内或最后一列内的移动不改变移回目标格后的局面，沿用父节点的对偶表值
+    template <typename BoardT>
+    bool dual_home_changed(const BoardT& parent, const BoardT& child, bool sampled) const {
+        const int cols = parent.cols();
+        if (parent.blank / cols == child.blank / cols || parent.blank % cols == cols - 1) {
+            if (sampled) {
+                stats->dual_reused.fetch_add(1, std::memory_order_relaxed);
+            }
+            return false;
+        }
+        if (sampled) {
+            stats->dual_lookups.fetch_add(static_cast<long long>(databases.size()), std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    template <typename BoardT>
+    int child(const BoardT& parent, const NodeData& parent_data, const BoardT& child, int, NodeData& child_data) const {
+        const bool sampled = sample();
+        unsigned affected;
+        unsigned reflected_affected;
+        moved_groups(parent, child, affected, reflected_affected, sampled);
+        child_data = parent_data;
+        for (; affected != 0; affected &= affected - 1) {
+            int group = __builtin_ctz(affected);
+            child_data.values[group] = static_cast<uint8_t>(lookup(child, group));
+        }
+        for (; reflected_affected != 0; reflected_affected &= reflected_affected - 1) {
+            int group = __builtin_ctz(reflected_affected);
+            child_data.reflected[group] = static_cast<uint8_t>(lookup_reflected(child, group));
+        }
+        if (dual && dual_home_changed(parent, child, sampled)) {
+            child_data.dual_home = static_cast<uint8_t>(lookup_dual_home(child));
+        }
+        return evaluate(child, child_data, sampled);
+    }
+
+    // 与 child 相同，但先为所有子节点的所有查表算出表项位置并预取，再统一读出，
+    // 表不在缓存中时各次访存的延迟互相重叠；各子节点的表值组合由 reduce_lanes 一次完成，每个子节点占一个 SIMD 通道
+    template <typename BoardT>
+    void children(const BoardT& parent, const NodeData& parent_data, ChildSlot<BoardT, NodeData>* slots, int count, int) const {
+        // 一次待读的查表：表项位置、所属的表与表值写回的位置；常规、反射与对偶查表排在同一个数组里
+        struct PendingLookup {
+            PatternDatabase::Probe probe;
+            const PatternDatabase* database;
+            uint8_t* target;
+        };
+        std::array<PendingLookup, 3 * kMaxChildBatch * kMaxGroups> pending;
+        std::array<std::array<uint8_t, kMaxGroups>, kMaxChildBatch> dual_values;
+        std::array<bool, kMaxChildBatch> dual_fresh{};
+        int pending_count = 0;
+        std::array<uint8_t, 64> positions{};
+        const bool sampled = sample();
+        for (int c = 0; c < count; ++c) {
+            const BoardT& child = *slots[c].board;
+            NodeData& child_data = *slots[c].data;
+            unsigned affected;
+            unsigned reflected_affected;
+            moved_groups(parent, child, affected, reflected_affected, sampled);
+            child_data = parent_data;
+            for (; affected != 0; affected &= affected - 1) {
+                int group = __builtin_ctz(affected);
+                positions_of(child, group, positions.data());
+                pending[pending_count++] = {databases[group]->probe(positions.data()), databases[group].get(), &child_data.values[group]};
+            }
+            for (; reflected_affected != 0; reflected_affected &= reflected_affected - 1) {
+                int group = __builtin_ctz(reflected_affected);
+                reflected_positions_of(child, group, positions.data());
+                pending[pending_count++] = {databases[group]->probe(positions.data()), databases[group].get(), &child_data.reflected[group]};
+            }
+            dual_values[c] = {};
+            if (dual && dual_home_changed(parent, child, sampled)) {
+                std::array<PatternDatabase::Probe, kMaxGroups> probes;
+                dual_home_probes(child, probes.data());
+                for (size_t g = 0; g < databases.size(); ++g) {
+                    pending[pending_count++] = {probes[g], databases[g].get(), &dual_values[c][g]};
+                }
+                dual_fresh[c] = true;
+            }
+        }
+        for (int i = 0; i < pending_count; ++i) {
+            PatternDatabase::prefetch(pending[i].probe);
+        }
+        for (int i = 0; i < pending_count; ++i) {
+            *pending[i].target = static_cast<uint8_t>(pending[i].database->value(pending[i].probe));
+        }
+        // 按子节点逐行归约：additive 时取和，否则取最大值
+        std::array<std::array<uint8_t, kMaxGroups>, kMaxChildBatch> lanes;
+        std::array<int, kMaxChildBatch> sums;
+        std::array<int, kMaxChildBatch> maxima;
+        auto reduce = [&](auto&& values_of, std::array<int, kMaxChildBatch>& combined) {
+            for (int c = 0; c < count; ++c) {
+                lanes[c] = values_of(c);
+            }
+            reduce_lanes(lanes[0].data(), count, sums.data(), maxima.data());
+            combined = additive ? sums : maxima;
+        };
+        std::array<int, kMaxChildBatch> regular;
+        std::array<int, kMaxChildBatch> reflected{};
+        reduce([&](int c) { return slots[c].data->values; }, regular);
+        if (reflect) {
+            reduce([&](int c) { return slots[c].data->reflected; }, reflected);
+        }
+        if (dual) {
+            std::array<int, kMaxChildBatch> dual_combined;
+            reduce([&](int c) { return dual_values[c]; }, dual_combined);
+            for (int c = 0; c < count; ++c) {
+                if (dual_fresh[c]) {
+                    slots[c].data->dual_home = static_cast<uint8_t>(dual_combined[c]);
+                }
+            }
+        }
+        for (int c = 0; c < count; ++c) {
+            slots[c].h = evaluate_combined(*slots[c].board, regular[c], reflected[c], slots[c].data->dual_home, sampled);
+        }
+    }
+};
+
+// 策略是否提供带剪枝上限的 child（见文件开头）
+template <typename Heuristic, typename = void>
+struct is_bounded_heuristic : std::false_type {};
+
+template <typename Heuristic>
+struct is_bounded_heuristic<Heuristic, std::void_t<decltype(Heuristic::kBounded)>> : std::bool_constant<Heuristic::kBounded> {};
+
+// 策略是否提供批量的 children（见文件开头）
+template <typename Heuristic, typename = void>
+struct is_batched_heuristic : std::false_type {};
+
+template <typename Heuristic>
+struct is_batched_heuristic<Heuristic, std::void_t<decltype(Heuristic::kBatched)>> : std::bool_constant<Heuristic::kBatched> {};
+
+// 计算一个子节点的启发值，支持剪枝上限的策略传入 limit
+template <typename Heuristic, typename BoardT>
+int evaluate_child(const Heuristic& heuristic, const BoardT& parent, const typename Heuristic::NodeData& parent_data, const BoardT& child,
+                   int child_manhattan, typename Heuristic::NodeData& child_data, int limit) {
+    if constexpr (is_bounded_heuristic<Heuristic>::value) {
+        return heuristic.child(parent, parent_data, child, child_manhattan, child_data, limit);
+    } else {
+        return heuristic.child(parent, parent_data, child, child_manhattan, child_data);
+    }
+}
+
+// 计算同一父节点的 count（不超过 kMaxChildBatch）个子节点的启发值：批量策略一次算完，其余（以及只有一个子节点时）逐个调用 child
+template <typename Heuristic, typename BoardT>
+void evaluate_children(const Heuristic& heuristic, const BoardT& parent, const typename Heuristic::NodeData& parent_data,
+                       ChildSlot<BoardT, typename Heuristic::NodeData>* slots, int count, int limit) {
+    if constexpr (is_batched_heuristic<Heuristic>::value) {
+        if (count > 1) {
+            heuristic.children(parent, parent_data, slots, count, limit);
+            return;
+        }
+    }
+    for (int i = 0; i < count; ++i) {
+        slots[i].h = evaluate_child(heuristic, parent, parent_data, *slots[i].board, slots[i].manhattan, *slots[i].data, limit);
+    }
+}
+
+#endif // HEURISTICS_HPP
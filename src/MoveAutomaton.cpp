@@ -0,0 +1,290 @@
+#include "MoveAutomaton.hpp"
+#include "ShapeTables.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <tuple>
+#include <unordered_set>
+#include <utility>
+
+#include <spdlog/spdlog.h>
+
+namespace {
+
+const char* solve_type_name(SolveType type) {
+    return type == SolveType::AdjacentSwap ? "adjacent" : "block";
+}
+
+// 移动串中的一步
+struct MoveStep {
+    int direction;
+    int length;
+};
+
+// 在以格子编号为数字的棋盘 cells 上，从空格 blank 出发执行一步；射线不够长时返回 false
+bool apply_step(const ShapeTables& t, std::string& cells, int& blank, MoveStep move) {
+    if (move.length > t.ray_length[blank][move.direction]) {
+        return false;
+    }
+    const int step = t.step[move.direction];
+    for (int k = 0; k < move.length; ++k) {
+        std::swap(cells[blank], cells[blank + step]);
+        blank += step;
+    }
+    return true;
+}
+
+} // namespace
+
+MoveAutomaton MoveAutomaton::learn(int rows, int cols, SolveType type, int depth) {
+    const ShapeTables& t = shape_tables(rows, cols);
+    const int cell_count = rows * cols;
+    const int shift = max_shift(rows, cols, type);
+    const int symbols = ShapeTables::kDirections * shift;
+    auto decode = [&](char symbol) {
+        return MoveStep{static_cast<unsigned char>(symbol) / shift, static_cast<unsigned char>(symbol) % shift + 1};
+    };
+
+    std::string identity(cell_count, '\0');
+    for (int pos = 0; pos < cell_count; ++pos) {
+        identity[pos] = static_cast<char>(pos);
+    }
+
+    // minimal[p]：空格起点为 p 时所有长度不超过 depth 的最小串；candidates：在某个起点上是重复串的串
+    std::vector<std::unordered_set<std::string>> minimal(cell_count);
+    std::set<std::string> candidates;
+
+    struct Node {
+        std::string moves;
+        std::string cells;
+        int blank;
+    };
+    for (int start = 0; start < cell_count; ++start) {
+        std::unordered_set<std::string> seen{identity};
+        std::vector<Node> level{{std::string(), identity, start}};
+        minimal[start].insert(std::string());
+
+        // 每层按字典序扩展上一层的最小串，得到的下一层仍按字典序排列，先出现的即为最小串
+        for (int d = 0; d < depth && !level.empty(); ++d) {
+            std::vector<Node> next_level;
+            for (const Node& node : level) {
+                for (int symbol = 0; symbol < symbols; ++symbol) {
+                    Node child{node.moves + static_cast<char>(symbol), node.cells, node.blank};
+                    if (!apply_step(t, child.cells, child.blank, decode(static_cast<char>(symbol)))) {
+                        continue;
+                    }
+                    if (seen.insert(child.cells).second) {
+                        minimal[start].insert(child.moves);
+                        next_level.push_back(std::move(child));
+                    } else {
+                        candidates.insert(std::move(child.moves));
+                    }
+                }
+            }
+            level = std::move(next_level);
+        }
+    }
+
+    // 只禁止在所有合法起点上都不是最小串的串
+    std::vector<std::string> forbidden;
+    for (const std::string& moves : candidates) {
+        bool redundant_everywhere = true;
+        for (int start = 0; start < cell_count && redundant_everywhere; ++start) {
+            std::string cells = identity;
+            int blank = start;
+            bool legal = true;
+            for (char symbol : moves) {
+                legal = legal && apply_step(t, cells, blank, decode(symbol));
+            }
+            if (legal && minimal[start].count(moves) > 0) {
+                redundant_everywhere = false;
+            }
+        }
+        if (redundant_everywhere) {
+            forbidden.push_back(moves);
+        }
+    }
+
+    MoveAutomaton automaton;
+    automaton.rows_ = rows;
+    automaton.cols_ = cols;
+    automaton.type_ = type;
+    automaton.depth_ = depth;
+    automaton.max_shift_ = shift;
+    automaton.symbol_count_ = symbols;
+    automaton.build(forbidden);
+    return automaton;
+}
+
+// 由禁止串构造 Aho–Corasick 自动机，并删去“已匹配到禁止串”的状态，只保留存活状态的完整转移表
+void MoveAutomaton::build(const std::vector<std::string>& forbidden) {
+    forbidden_count_ = static_cast<int>(forbidden.size());
+    std::vector<std::vector<int32_t>> go(1, std::vector<int32_t>(symbol_count_, -1));
+    std::vector<char> terminal(1, 0);
+    for (const std::string& moves : forbidden) {
+        int32_t node = 0;
+        for (char c : moves) {
+            int symbol = static_cast<unsigned char>(c);
+            if (go[node][symbol] < 0) {
+                go[node][symbol] = static_cast<int32_t>(go.size());
+                go.emplace_back(symbol_count_, -1);
+                terminal.push_back(0);
+            }
+            node = go[node][symbol];
+        }
+        terminal[node] = 1;
+    }
+
+    // 按 BFS 顺序补全转移：失配时沿失败链接回退，失败链接指向的状态先于自身完成
+    std::vector<int32_t> fail(go.size(), 0);
+    std::deque<int32_t> queue;
+    for (int symbol = 0; symbol < symbol_count_; ++symbol) {
+        int32_t child = go[0][symbol];
+        if (child < 0) {
+            go[0][symbol] = 0;
+        } else {
+            fail[child] = 0;
+            queue.push_back(child);
+        }
+    }
+    while (!queue.empty()) {
+        int32_t node = queue.front();
+        queue.pop_front();
+        terminal[node] = terminal[node] || terminal[fail[node]];
+        for (int symbol = 0; symbol < symbol_count_; ++symbol) {
+            int32_t child = go[node][symbol];
+            if (child < 0) {
+                go[node][symbol] = go[fail[node]][symbol];
+            } else {
+                fail[child] = go[fail[node]][symbol];
+                queue.push_back(child);
+            }
+        }
+    }
+
+    std::vector<int32_t> live_id(go.size(), kPruned);
+    int32_t live_count = 0;
+    for (size_t node = 0; node < go.size(); ++node) {
+        if (!terminal[node]) {
+            live_id[node] = live_count++;
+        }
+    }
+    transitions_.assign(static_cast<size_t>(live_count) * symbol_count_, kPruned);
+    direction_masks_.assign(live_count, 0);
+    for (size_t node = 0; node < go.size(); ++node) {
+        if (terminal[node]) continue;
+        for (int symbol = 0; symbol < symbol_count_; ++symbol) {
+            int32_t target = live_id[go[node][symbol]];
+            transitions_[static_cast<size_t>(live_id[node]) * symbol_count_ + symbol] = target;
+            if (target != kPruned) {
+                direction_masks_[live_id[node]] |= static_cast<uint8_t>(1u << (symbol / max_shift_));
+            }
+        }
+    }
+}
+
+std::string MoveAutomaton::file_path(int rows, int cols, SolveType type) {
+    const char* dir = std::getenv("NUMBER_SLIDER_FSM_DIR");
+    std::filesystem::path base = (dir != nullptr && dir[0] != '\0') ? dir : "automata";
+    std::string name = "fsm_" + std::to_string(rows) + "x" + std::to_string(cols) + "_" + solve_type_name(type) + ".txt";
+    return (base / name).string();
+}
+
+std::shared_ptr<const MoveAutomaton> MoveAutomaton::get(int rows, int cols, SolveType type) {
+    static std::mutex registry_mutex;
+    static std::map<std::tuple<int, int, SolveType>, std::shared_ptr<const MoveAutomaton>> registry;
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    auto& slot = registry[{rows, cols, type}];
+    if (slot) {
+        return slot;
+    }
+    auto automaton = std::make_shared<MoveAutomaton>();
+    const std::string path = file_path(rows, cols, type);
+    if (load(path, rows, cols, type, *automaton)) {
+        spdlog::default_logger()->info("Loaded move automaton from {}.", path);
+    } else {
+        int depth = type == SolveType::AdjacentSwap ? kDefaultAdjacentDepth : kDefaultBlockShiftDepth;
+        *automaton = learn(rows, cols, type, depth);
+    }
+    spdlog::default_logger()->info("Move automaton for {}x{} {}: depth {}, {} forbidden strings, {} states.",
+                                   rows, cols, solve_type_name(type), automaton->depth(), automaton->forbidden_count(), automaton->state_count());
+    slot = automaton;
+    return slot;
+}
+
+bool MoveAutomaton::save(const std::string& path) const {
+    std::error_code ec;
+    std::filesystem::path target(path);
+    if (target.has_parent_path()) {
+        std::filesystem::create_directories(target.parent_path(), ec);
+    }
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) {
+        return false;
+    }
+    out << "number_slider_move_automaton 1 " << rows_ << ' ' << cols_ << ' ' << solve_type_name(type_) << ' '
+        << depth_ << ' ' << forbidden_count_ << ' ' << symbol_count_ << ' ' << state_count() << '\n';
+    for (int state = 0; state < state_count(); ++state) {
+        for (int symbol = 0; symbol < symbol_count_; ++symbol) {
+            out << (symbol == 0 ? "" : " ") << next(state, symbol);
+        }
+        out << '\n';
+    }
+    return static_cast<bool>(out);
+}
+
+bool MoveAutomaton::load(const std::string& path, int rows, int cols, SolveType type, MoveAutomaton& out) {
+    std::ifstream in(path);
+    if (!in) {
+        return false;
+    }
+    std::string magic;
+    std::string type_name;
+    int version = 0;
+    int file_rows = 0;
+    int file_cols = 0;
+    int depth = 0;
+    int forbidden = 0;
+    int symbols = 0;
+    int states = 0;
+    in >> magic >> version >> file_rows >> file_cols >> type_name >> depth >> forbidden >> symbols >> states;
+    const int shift = max_shift(rows, cols, type);
+    if (!in || magic != "number_slider_move_automaton" || version != 1 || file_rows != rows || file_cols != cols ||
+        type_name != solve_type_name(type) || symbols != ShapeTables::kDirections * shift || states <= 0) {
+        spdlog::default_logger()->warn("Ignoring move automaton {} with mismatched header.", path);
+        return false;
+    }
+
+    MoveAutomaton automaton;
+    automaton.rows_ = rows;
+    automaton.cols_ = cols;
+    automaton.type_ = type;
+    automaton.depth_ = depth;
+    automaton.max_shift_ = shift;
+    automaton.symbol_count_ = symbols;
+    automaton.forbidden_count_ = forbidden;
+    automaton.transitions_.resize(static_cast<size_t>(states) * symbols);
+    automaton.direction_masks_.assign(states, 0);
+    for (int state = 0; state < states; ++state) {
+        for (int symbol = 0; symbol < symbols; ++symbol) {
+            int32_t target = kPruned;
+            if (!(in >> target) || target < kPruned || target >= states) {
+                spdlog::default_logger()->warn("Move automaton {} is truncated or corrupt.", path);
+                return false;
+            }
+            automaton.transitions_[static_cast<size_t>(state) * symbols + symbol] = target;
+            if (target != kPruned) {
+                automaton.direction_masks_[state] |= static_cast<uint8_t>(1u << (symbol / shift));
+            }
+        }
+    }
+    out = std::move(automaton);
+    return true;
+}
@@ -0,0 +1,68 @@
+#ifndef MOVE_AUTOMATON_HPP
+#define MOVE_AUTOMATON_HPP
+
+#include "SolveType.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// 深度优先搜索用的重复路径剪枝自动机 (Taylor & Korf)。
+// 从同一空格起点出发、得到同一棋盘的若干移动串中只保留按 (长度, 字典序) 最小的一串，其余为重复串。
+// 学习时对每个空格起点做 BFS，枚举不超过 depth 步的移动串，记下最小串与重复串；
+// 只有在所有能合法执行它的起点上都是重复串的串才被禁止，所以剪枝与空格当前位置无关。
+// 最小串的任意子串仍是最小串，因此每个状态的最短路径中总有一条不含禁止串，IDA* 不会丢失最优解。
+//
+// 禁止串集合编译成 Aho–Corasick 自动机：搜索节点携带自动机状态，每走一步查一次转移表，
+// 转移结果为 kPruned 说明路径以某个禁止串结尾，该子节点不生成。逆向移动（以及批量位移下同一轴上的连续移动）
+// 是长度为 2 的禁止串，MovePruning.hpp 的剪枝表是它的特例。
+// 移动符号为 direction * max_shift + (length - 1)：相邻交换 max_shift 为 1，批量位移为 max(N, M) - 1。
+class MoveAutomaton {
+public:
+    static constexpr int32_t kStart = 0;   // 根节点的自动机状态
+    static constexpr int32_t kPruned = -1; // 转移到此表示该移动被剪枝
+    static constexpr int kDefaultAdjacentDepth = 8;
+    static constexpr int kDefaultBlockShiftDepth = 4;
+
+    // 离线学习：枚举不超过 depth 步的移动串
+    static MoveAutomaton learn(int rows, int cols, SolveType type, int depth);
+
+    // 某一形状与求解类型的自动机，进程内缓存，线程安全。
+    // 优先读取 fsm_builder 写出的表文件（目录由环境变量 NUMBER_SLIDER_FSM_DIR 指定，默认为 automata/），
+    // 没有时按默认深度现场学习
+    static std::shared_ptr<const MoveAutomaton> get(int rows, int cols, SolveType type);
+    static std::string file_path(int rows, int cols, SolveType type);
+
+    // 文本格式：一行文件头，之后每个状态一行转移
+    bool save(const std::string& path) const;
+    static bool load(const std::string& path, int rows, int cols, SolveType type, MoveAutomaton& out);
+
+    static int max_shift(int rows, int cols, SolveType type) {
+        return type == SolveType::AdjacentSwap ? 1 : (rows > cols ? rows : cols) - 1;
+    }
+
+    int symbol(int direction, int length) const { return direction * max_shift_ + length - 1; }
+    int32_t next(int32_t state, int symbol) const { return transitions_[static_cast<size_t>(state) * symbol_count_ + symbol]; }
+    // 该状态下至少有一种长度未被剪枝的方向位掩码，交给邻居枚举函数提前跳过整方向
+    unsigned directions(int32_t state) const { return direction_masks_[state]; }
+
+    int state_count() const { return static_cast<int>(direction_masks_.size()); }
+    int symbol_count() const { return symbol_count_; }
+    int depth() const { return depth_; }
+    int forbidden_count() const { return forbidden_count_; }
+
+private:
+    void build(const std::vector<std::string>& forbidden);
+
+    int rows_ = 0;
+    int cols_ = 0;
+    SolveType type_ = SolveType::AdjacentSwap;
+    int depth_ = 0;
+    int max_shift_ = 1;
+    int symbol_count_ = 0;
+    int forbidden_count_ = 0;
+    std::vector<int32_t> transitions_;    // [state * symbol_count + symbol]
+    std::vector<uint8_t> direction_masks_; // [state]
+};
+
+#endif // MOVE_AUTOMATON_HPP
@@ -0,0 +1,38 @@
+#ifndef MOVE_PRUNING_HPP
+#define MOVE_PRUNING_HPP
+
+#include "ShapeTables.hpp"
+#include "SolveType.hpp"
+#include <array>
+#include <cstdint>
+
+// 搜索节点记录的上一步空格移动方向（0 上，1 下，2 左，3 右），根节点没有上一步
+constexpr uint8_t kNoMove = ShapeTables::kDirections;
+constexpr uint8_t kAllDirections = (1u << ShapeTables::kDirections) - 1;
+
+constexpr int opposite_direction(int dir) { return dir ^ 1; } // 上 <-> 下，左 <-> 右
+
+// 算子剪枝表：kAllowedDirections[type][last] 为上一步方向是 last 时仍需生成的方向位掩码，第 dir 位对应方向 dir。
+// 相邻交换：反方向的一步只会回到父状态，剪去。
+// 批量位移：同一轴上连续两次位移（同向相加、反向相消）总能合并为至多一次位移，整条轴都剪去。
+// 被剪去的子状态都能由父状态以不多于一步到达，父状态扩展时已经生成过，不会丢失最优解。
+constexpr std::array<std::array<uint8_t, kNoMove + 1>, 2> make_allowed_directions() {
+    std::array<std::array<uint8_t, kNoMove + 1>, 2> table{};
+    for (int last = 0; last < kNoMove; ++last) {
+        table[static_cast<int>(SolveType::AdjacentSwap)][last] =
+            static_cast<uint8_t>(kAllDirections & ~(1u << opposite_direction(last)));
+        table[static_cast<int>(SolveType::BlockShift)][last] =
+            static_cast<uint8_t>(kAllDirections & ~((1u << last) | (1u << opposite_direction(last))));
+    }
+    table[static_cast<int>(SolveType::AdjacentSwap)][kNoMove] = kAllDirections;
+    table[static_cast<int>(SolveType::BlockShift)][kNoMove] = kAllDirections;
+    return table;
+}
+
+inline constexpr auto kAllowedDirections = make_allowed_directions();
+
+inline uint8_t allowed_directions(SolveType type, int last_move) {
+    return kAllowedDirections[static_cast<int>(type)][last_move];
+}
+
+#endif // MOVE_PRUNING_HPP
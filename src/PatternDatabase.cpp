@@ -0,0 +1,663 @@
+#include "PatternDatabase.hpp"
+#include "ShapeTables.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <tuple>
+#include <utility>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_reduce.h>
+
+#include <spdlog/spdlog.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define PATTERN_DATABASE_USE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// 模式数据库文件头，固定 128 字节，用零填充到 data_offset 后为表数据
+struct PatternFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t data_offset;  // 表数据在文件中的偏移，按页对齐
+    uint32_t rows;
+    uint32_t cols;
+    uint32_t solve_type;   // 0 相邻交换，1 批量位移
+    uint32_t ranking;      // 模式位置的排名方式
+    uint32_t tile_count;
+    uint32_t max_value;
+    uint64_t entry_count;  // 模式位置数
+    uint64_t checksum;     // 表数据的校验和
+    uint8_t tiles[64];     // 模式数字，按 tile_count 个有效
+    uint8_t encoding;      // 0 原始表值，1 压缩表（见 PatternStorage）
+    uint8_t value_bits;    // 压缩表每项的位数
+    uint8_t block_shift;   // 压缩表合并的排名块大小为 2^block_shift
+    uint8_t reserved[5];
+};
+static_assert(sizeof(PatternFileHeader) == 128, "pattern database file header must stay 128 bytes");
+
+constexpr char kPatternMagic[8] = {'N', 'S', 'S', 'P', 'D', 'B', '\0', '\0'};
+constexpr uint32_t kPatternVersion = 3;
+constexpr uint32_t kPatternDataOffset = 4096;
+constexpr uint32_t kRankingPartialLexicographic = 1; // rank_partial：按数字顺序的部分排列字典序排名
+
+// 按 8 字节字计算的 64 位 FNV-1a，尾部不足 8 字节的部分逐字节计入
+uint64_t fnv1a_words(const uint8_t* data, uint64_t size) {
+    constexpr uint64_t kPrime = 0x100000001B3ULL;
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    uint64_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * kPrime;
+    }
+    for (; i < size; ++i) {
+        hash = (hash ^ data[i]) * kPrime;
+    }
+    return hash;
+}
+
+bool env_flag(const char* name) {
+    const char* value = std::getenv(name);
+    return value != nullptr && value[0] != '\0' && std::strcmp(value, "0") != 0;
+}
+
+#ifdef PATTERN_DATABASE_USE_MMAP
+// 按 NUMBER_SLIDER_PDB_ADVICE 给映射的表数据加 madvise 提示：
+// random 关闭预读（查表是随机访问），willneed 让内核在后台预先调入整张表，hugepage 请求透明大页（需内核支持文件页的大页）
+void advise_mapping(void* base, size_t size) {
+    const char* value = std::getenv("NUMBER_SLIDER_PDB_ADVICE");
+    std::stringstream advice_in((value != nullptr && value[0] != '\0') ? value : "random");
+    std::string advice;
+    while (std::getline(advice_in, advice, ',')) {
+        if (advice == "random") {
+            ::madvise(base, size, MADV_RANDOM);
+        } else if (advice == "willneed") {
+            ::madvise(base, size, MADV_WILLNEED);
+#ifdef MADV_HUGEPAGE
+        } else if (advice == "hugepage") {
+            ::madvise(base, size, MADV_HUGEPAGE);
+#endif
+        } else if (!advice.empty() && advice != "none") {
+            spdlog::default_logger()->warn("Unknown pattern database advice '{}'; expected random, willneed, hugepage or none.", advice);
+        }
+    }
+}
+#endif
+
+const char* solve_type_name(SolveType type) {
+    return type == SolveType::AdjacentSwap ? "adjacent" : "block";
+}
+
+// 各形状的常用划分，第一个为默认划分
+struct NamedPartition {
+    int rows;
+    int cols;
+    const char* name;
+    std::vector<std::vector<int>> groups;
+};
+
+const std::vector<NamedPartition>& named_partitions() {
+    static const std::vector<NamedPartition> partitions = {
+        {4, 4, "6-6-3", {{1, 5, 6, 9, 10, 13}, {7, 8, 11, 12, 14, 15}, {2, 3, 4}}},
+        {4, 4, "7-8", {{1, 2, 3, 4, 5, 6, 7}, {8, 9, 10, 11, 12, 13, 14, 15}}},
+        {3, 5, "6-8", {{1, 2, 6, 7, 11, 12}, {3, 4, 5, 8, 9, 10, 13, 14}}},
+        {4, 5, "6-6-7", {{1, 2, 3, 6, 7, 8}, {4, 5, 9, 10, 14, 15}, {11, 12, 13, 16, 17, 18, 19}}},
+        {5, 5, "6-6-6-6", {{1, 2, 3, 6, 7, 8}, {4, 5, 9, 10, 14, 15}, {11, 12, 16, 17, 21, 22}, {13, 18, 19, 20, 23, 24}}},
+    };
+    return partitions;
+}
+
+// 线程私有的展开状态：当前模式位置的反排名结果与格子归属
+struct Expansion {
+    uint64_t placement = ~0ULL;
+    std::array<uint8_t, 64> positions{};
+    std::array<int8_t, 64> owner{}; // 格子 -> 模式数字下标，-1 为非模式格子
+    uint64_t occupied = 0;
+    std::vector<int> stack;
+};
+
+} // namespace
+
+std::string PatternStorage::name() const {
+    std::string name = value_bits == 8 ? "byte" : std::to_string(value_bits) + "bit";
+    if (block_shift > 0) {
+        name += "-min" + std::to_string(1 << block_shift);
+    }
+    return name;
+}
+
+uint64_t PatternStorage::table_bytes(uint64_t entries) const {
+    const uint64_t stored = ((entries - 1) >> block_shift) + 1;
+    return (stored * static_cast<uint64_t>(value_bits) + 7) / 8;
+}
+
+bool PatternStorage::parse(const std::string& spec, PatternStorage& storage) {
+    PatternStorage parsed;
+    const size_t dash = spec.find('-');
+    const std::string bits = spec.substr(0, dash);
+    if (bits == "byte") {
+        parsed.value_bits = 8;
+    } else if (bits == "4bit") {
+        parsed.value_bits = 4;
+    } else if (bits == "2bit") {
+        parsed.value_bits = 2;
+    } else {
+        return false;
+    }
+    if (dash != std::string::npos) {
+        const std::string block = spec.substr(dash + 1);
+        if (block.rfind("min", 0) != 0) {
+            return false;
+        }
+        int size = 0;
+        try {
+            size = std::stoi(block.substr(3));
+        } catch (const std::exception&) {
+            return false;
+        }
+        while (parsed.block_shift < kMaxBlockShift && (1 << parsed.block_shift) < size) {
+            ++parsed.block_shift;
+        }
+        if (size < 2 || (1 << parsed.block_shift) != size) {
+            return false;
+        }
+    }
+    storage = parsed;
+    return true;
+}
+
+std::vector<std::vector<int>> resolve_partition(int rows, int cols, const std::string& spec) {
+    for (const NamedPartition& partition : named_partitions()) {
+        if (partition.rows == rows && partition.cols == cols && (spec.empty() || spec == partition.name)) {
+            return partition.groups;
+        }
+    }
+    if (spec.empty() || spec.find(',') == std::string::npos) {
+        return {};
+    }
+
+    std::vector<std::vector<int>> groups;
+    uint64_t used = 0;
+    std::stringstream groups_in(spec);
+    std::string group_spec;
+    while (std::getline(groups_in, group_spec, '/')) {
+        std::vector<int> group;
+        std::stringstream tiles_in(group_spec);
+        std::string tile_spec;
+        while (std::getline(tiles_in, tile_spec, ',')) {
+            int tile = 0;
+            try {
+                tile = std::stoi(tile_spec);
+            } catch (const std::exception&) {
+                return {};
+            }
+            if (tile < 1 || tile >= rows * cols || (used >> tile & 1) != 0) {
+                return {};
+            }
+            used |= 1ULL << tile;
+            group.push_back(tile);
+        }
+        if (group.empty()) {
+            return {};
+        }
+        groups.push_back(std::move(group));
+    }
+    return groups;
+}
+
+PatternDatabase::PatternDatabase(int rows, int cols, SolveType type, const std::vector<int>& tiles, PatternStorage storage)
+    : rows_(rows), cols_(cols), type_(type), tiles_(tiles), storage_(storage),
+      offset_scale_(storage.compressed() && type == SolveType::AdjacentSwap ? 2 : 1), goal_distance_(tiles.size() * 64, 0) {
+    for (size_t i = 0; i < tiles_.size(); ++i) {
+        const int goal = tiles_[i] - 1;
+        for (int cell = 0; cell < rows_ * cols_; ++cell) {
+            goal_distance_[i * 64 + cell] = static_cast<uint8_t>(std::abs(cell / cols_ - goal / cols_) + std::abs(cell % cols_ - goal % cols_));
+        }
+    }
+}
+
+std::string PatternDatabase::file_name(int rows, int cols, SolveType type, const std::vector<int>& tiles, PatternStorage storage) {
+    std::string name = "pdb_" + std::to_string(rows) + "x" + std::to_string(cols) + "_" + solve_type_name(type);
+    for (size_t i = 0; i < tiles.size(); ++i) {
+        name += (i == 0 ? "_" : "-") + std::to_string(tiles[i]);
+    }
+    if (storage.compressed()) {
+        name += "_" + storage.name();
+    }
+    return name + ".bin";
+}
+
+std::string PatternDatabase::file_path(int rows, int cols, SolveType type, const std::vector<int>& tiles, PatternStorage storage) {
+    const char* dir = std::getenv("NUMBER_SLIDER_PDB_DIR");
+    std::filesystem::path base = (dir != nullptr && dir[0] != '\0') ? dir : "pdbs";
+    return (base / file_name(rows, cols, type, tiles, storage)).string();
+}
+
+uint64_t PatternDatabase::build_memory_bytes(int rows, int cols, int tile_count) {
+    const uint64_t placements = partial_permutation_count(rows * cols, tile_count);
+    const uint64_t bitmap_bytes = (placements * static_cast<uint64_t>(rows * cols - tile_count) + 63) / 64 * 8;
+    return placements + 3 * bitmap_bytes;
+}
+
+std::shared_ptr<const PatternDatabase> PatternDatabase::get(int rows, int cols, SolveType type, const std::vector<int>& tiles,
+                                                            PatternStorage storage) {
+    static std::mutex registry_mutex;
+    static std::map<std::tuple<int, int, SolveType, std::vector<int>, std::string>, std::shared_ptr<const PatternDatabase>> registry;
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    auto found = registry.find({rows, cols, type, tiles, storage.name()});
+    if (found != registry.end()) {
+        return found->second;
+    }
+    // 只映射已有文件，不构造、不写文件
+    auto map = [&](PatternStorage wanted) -> std::shared_ptr<PatternDatabase> {
+        std::shared_ptr<PatternDatabase> database(new PatternDatabase(rows, cols, type, tiles, wanted));
+        return database->map_file(file_path(rows, cols, type, tiles, wanted)) ? database : nullptr;
+    };
+    std::shared_ptr<PatternDatabase> database = map(storage);
+    if (!database && storage.compressed()) {
+        // 没有压缩表文件时由已映射的原始表在内存中换算；原始表只作换算来源，不进缓存，换算完即释放
+        if (std::shared_ptr<PatternDatabase> raw = map({})) {
+            database = compress(*raw, storage);
+        }
+    }
+    if (!database) {
+        std::string spec; // resolve_partition 接受的显式写法，只含这一个模式
+        for (size_t i = 0; i < tiles.size(); ++i) {
+            spec += (i == 0 ? "" : ",") + std::to_string(tiles[i]);
+        }
+        // 缺失时不缓存，pdb_builder 写出文件后同一进程的下次求解即可使用
+        spdlog::default_logger()->warn("Pattern database {} not found; build it offline with: pdb_builder {} {} {} \"{}\"{}", file_path(rows, cols, type, tiles, storage),
+                                       rows, cols, solve_type_name(type), spec,
+                                       storage.compressed() ? " --storage=" + storage.name() : std::string());
+        return nullptr;
+    }
+    registry[{rows, cols, type, tiles, storage.name()}] = database;
+    return database;
+}
+
+std::shared_ptr<PatternDatabase> PatternDatabase::build(int rows, int cols, SolveType type, const std::vector<int>& tiles) {
+    const int cells = rows * cols;
+    const int k = static_cast<int>(tiles.size());
+    if (cells > ShapeTables::kMaxCells || k < 1 || k >= cells || partial_permutation_count(cells, k) > kMaxEntries) {
+        spdlog::default_logger()->error("Pattern of {} tiles on {}x{} is too large to build.", k, rows, cols);
+        return nullptr;
+    }
+    std::shared_ptr<PatternDatabase> database(new PatternDatabase(rows, cols, type, tiles));
+    spdlog::default_logger()->info("Building {}x{} {} pattern database for {} tiles ({} entries, about {} MB)...",
+                                   rows, cols, solve_type_name(type), k, partial_permutation_count(cells, k),
+                                   build_memory_bytes(rows, cols, k) >> 20);
+    auto start = std::chrono::steady_clock::now();
+    database->run_bfs();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    spdlog::default_logger()->info("Pattern database built in {:.2f} seconds, max value {}.", elapsed.count(), database->max_value());
+    return database;
+}
+
+std::shared_ptr<PatternDatabase> PatternDatabase::compress(const PatternDatabase& raw, PatternStorage storage) {
+    const int cells = raw.rows_ * raw.cols_;
+    const int k = static_cast<int>(raw.tiles_.size());
+    std::shared_ptr<PatternDatabase> database(new PatternDatabase(raw.rows_, raw.cols_, raw.type_, raw.tiles_, storage));
+    database->entry_count_ = raw.entry_count_;
+    database->table_bytes_ = storage.table_bytes(raw.entry_count_);
+    database->owned_table_.assign(database->table_bytes_, 0);
+    database->table_ = database->owned_table_.data();
+
+    const int per_byte = 8 / storage.value_bits;
+    const int max_code = (1 << storage.value_bits) - 1;
+    const uint64_t stored = ((raw.entry_count_ - 1) >> storage.block_shift) + 1;
+    auto start = std::chrono::steady_clock::now();
+    // 每个任务写整字节，避免多个线程写同一字节；返回被截断的项数
+    uint64_t clamped = tbb::parallel_reduce(
+        tbb::blocked_range<uint64_t>(0, database->table_bytes_), uint64_t{0},
+        [&](const tbb::blocked_range<uint64_t>& range, uint64_t count) {
+            std::array<uint8_t, 64> positions{};
+            for (uint64_t byte = range.begin(); byte != range.end(); ++byte) {
+                for (int slot = 0; slot < per_byte; ++slot) {
+                    const uint64_t index = byte * per_byte + static_cast<uint64_t>(slot);
+                    if (index >= stored) {
+                        break;
+                    }
+                    // 块内最小偏移；全部不可达时记 0
+                    int offset = -1;
+                    const uint64_t first = index << storage.block_shift;
+                    const uint64_t last = std::min(raw.entry_count_, (index + 1) << storage.block_shift);
+                    for (uint64_t rank = first; rank < last; ++rank) {
+                        const int value = raw.table_[rank];
+                        if (value == kUnreached) {
+                            continue;
+                        }
+                        int base = 0;
+                        if (database->offset_scale_ != 1) {
+                            unrank_partial(rank, k, cells, positions.data());
+                            for (int i = 0; i < k; ++i) {
+                                base += database->goal_distance_[i * 64 + positions[i]];
+                            }
+                        }
+                        const int candidate = std::max(0, value - base) / database->offset_scale_;
+                        offset = offset < 0 ? candidate : std::min(offset, candidate);
+                    }
+                    if (offset > max_code) {
+                        ++count;
+                        offset = max_code;
+                    }
+                    database->owned_table_[byte] |= static_cast<uint8_t>(std::max(offset, 0) << (slot * storage.value_bits));
+                }
+            }
+            return count;
+        },
+        std::plus<uint64_t>());
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    database->max_value_ = raw.max_value_;
+    spdlog::default_logger()->info("Compressed pattern database to {} ({:.2f} MB -> {:.2f} MB) in {:.2f} seconds, {} entries clamped.",
+                                   storage.name(), raw.table_bytes_ / 1048576.0, database->table_bytes_ / 1048576.0, elapsed.count(), clamped);
+    return database;
+}
+
+PatternDatabase::~PatternDatabase() {
+#ifdef PATTERN_DATABASE_USE_MMAP
+    if (mapping_ != nullptr) {
+        ::munmap(mapping_, mapping_size_);
+    }
+#endif
+}
+
+uint64_t PatternDatabase::checksum() const {
+    return fnv1a_words(table_, table_bytes_);
+}
+
+// 逐层同步的并行 0-1 BFS。
+// 状态编号为 模式位置排名 * free_cells + 空格在非模式格子中的序号。current 位图标记本层状态，
+// 每个状态只展开推动模式数字的移动（代价 1）；子状态所在的空格连通块整体属于下一层，
+// 各线程用原子或操作认领 visited 中的位，只展开自己认领到的格子，所以每个连通块恰好被完整标记一次。
+void PatternDatabase::run_bfs() {
+    const ShapeTables& t = shape_tables(rows_, cols_);
+    const int cells = rows_ * cols_;
+    const int k = static_cast<int>(tiles_.size());
+    const int free_cells = cells - k;
+    const uint64_t all_cells = cells == 64 ? ~0ULL : (1ULL << cells) - 1;
+    const uint64_t placements = partial_permutation_count(cells, k);
+    const size_t words = static_cast<size_t>((placements * free_cells + 63) / 64);
+    owned_table_.assign(placements, kUnreached);
+    uint8_t* table = owned_table_.data();
+    table_ = table;
+    entry_count_ = placements;
+    table_bytes_ = placements;
+
+    std::vector<uint64_t> visited(words, 0);
+    std::vector<uint64_t> current(words, 0);
+    std::vector<uint64_t> next(words, 0);
+
+    auto state_of = [&](uint64_t placement, uint64_t occupied, int blank) {
+        uint64_t below = (1ULL << blank) - 1;
+        return placement * free_cells + static_cast<uint64_t>(popcount64(~occupied & below));
+    };
+    auto claim = [&](uint64_t state) {
+        const uint64_t bit = 1ULL << (state & 63);
+        if (__atomic_load_n(&visited[state >> 6], __ATOMIC_RELAXED) & bit) {
+            return false;
+        }
+        return (__atomic_fetch_or(&visited[state >> 6], bit, __ATOMIC_RELAXED) & bit) == 0;
+    };
+    // 从 blank 出发，把空格只经过非模式格子能到达的位置认领并加入 frontier，返回认领的状态数
+    auto close = [&](uint64_t placement, uint64_t occupied, int blank, std::vector<uint64_t>& frontier, std::vector<int>& stack) {
+        uint64_t state = state_of(placement, occupied, blank);
+        if (!claim(state)) {
+            return uint64_t{0};
+        }
+        uint64_t count = 0;
+        stack.assign(1, blank);
+        while (!stack.empty()) {
+            int pos = stack.back();
+            stack.pop_back();
+            state = state_of(placement, occupied, pos);
+            __atomic_fetch_or(&frontier[state >> 6], 1ULL << (state & 63), __ATOMIC_RELAXED);
+            ++count;
+            const ShapeTables::AdjacentMoves& moves = t.adjacent[pos];
+            for (int i = 0; i < moves.count; ++i) {
+                int target = moves.target[i];
+                if ((occupied >> target & 1) == 0 && claim(state_of(placement, occupied, target))) {
+                    stack.push_back(target);
+                }
+            }
+        }
+        return count;
+    };
+    auto record = [&](uint64_t placement, int value) {
+        if (__atomic_load_n(&table[placement], __ATOMIC_RELAXED) == kUnreached) {
+            __atomic_store_n(&table[placement], static_cast<uint8_t>(value), __ATOMIC_RELAXED);
+        }
+    };
+
+    Expansion root;
+    for (int i = 0; i < k; ++i) {
+        root.positions[i] = static_cast<uint8_t>(tiles_[i] - 1);
+        root.occupied |= 1ULL << root.positions[i];
+    }
+    uint64_t goal = rank_partial(root.positions.data(), k, cells);
+    record(goal, 0);
+    close(goal, root.occupied, cells - 1, current, root.stack);
+
+    for (int depth = 0;; ++depth) {
+        const int child_value = depth + 1;
+        uint64_t found = tbb::parallel_reduce(
+            tbb::blocked_range<size_t>(0, words), uint64_t{0},
+            [&](const tbb::blocked_range<size_t>& range, uint64_t count) {
+                Expansion e;
+                std::array<uint8_t, 64> moved{};
+                for (size_t w = range.begin(); w != range.end(); ++w) {
+                    for (uint64_t bits = current[w]; bits != 0; bits &= bits - 1) {
+                        uint64_t state = w * 64 + static_cast<uint64_t>(__builtin_ctzll(bits));
+                        uint64_t placement = state / free_cells;
+                        if (placement != e.placement) {
+                            e.placement = placement;
+                            unrank_partial(placement, k, cells, e.positions.data());
+                            e.owner.fill(-1);
+                            e.occupied = 0;
+                            for (int i = 0; i < k; ++i) {
+                                e.owner[e.positions[i]] = static_cast<int8_t>(i);
+                                e.occupied |= 1ULL << e.positions[i];
+                            }
+                        }
+                        const int blank = select_bit(~e.occupied & all_cells, static_cast<int>(state % free_cells));
+
+                        // 只展开推动了模式数字的移动，其余移动已在 close 中展开
+                        for (int dir = 0; dir < ShapeTables::kDirections; ++dir) {
+                            const int step = t.step[dir];
+                            const int length = type_ == SolveType::AdjacentSwap ? std::min<int>(1, t.ray_length[blank][dir]) : t.ray_length[blank][dir];
+                            moved = e.positions;
+                            uint64_t occupied = e.occupied;
+                            bool pushes_pattern = false;
+                            for (int l = 1; l <= length; ++l) {
+                                const int cell = blank + l * step;
+                                const int tile = e.owner[cell];
+                                if (tile >= 0) {
+                                    moved[tile] = static_cast<uint8_t>(cell - step);
+                                    occupied = (occupied & ~(1ULL << cell)) | (1ULL << (cell - step));
+                                    pushes_pattern = true;
+                                }
+                                if (!pushes_pattern) {
+                                    continue;
+                                }
+                                uint64_t child = rank_partial(moved.data(), k, cells);
+                                uint64_t added = close(child, occupied, cell, next, e.stack);
+                                if (added > 0) {
+                                    record(child, child_value);
+                                    count += added;
+                                }
+                            }
+                        }
+                    }
+                }
+                return count;
+            },
+            std::plus<uint64_t>());
+        if (found == 0) {
+            break;
+        }
+        spdlog::default_logger()->debug("Pattern database depth {}: {} states.", child_value, found);
+        current.swap(next);
+        std::fill(next.begin(), next.end(), 0);
+    }
+    // 最后几层可能只发现已有模式位置的新空格连通块，表中的最大值以表为准
+    max_value_ = *std::max_element(owned_table_.begin(), owned_table_.end());
+}
+
+bool PatternDatabase::map_file(const std::string& path) {
+    const uint64_t entries = partial_permutation_count(rows_ * cols_, static_cast<int>(tiles_.size()));
+    const uint64_t bytes = storage_.table_bytes(entries);
+    auto header_matches = [&](const PatternFileHeader& header, uint64_t file_size) {
+        if (std::memcmp(header.magic, kPatternMagic, sizeof(kPatternMagic)) != 0 || header.version != kPatternVersion ||
+            header.data_offset < sizeof(PatternFileHeader) || header.rows != static_cast<uint32_t>(rows_) ||
+            header.cols != static_cast<uint32_t>(cols_) || header.solve_type != static_cast<uint32_t>(type_) ||
+            header.ranking != kRankingPartialLexicographic || header.tile_count != tiles_.size() ||
+            header.entry_count != entries || header.encoding != (storage_.compressed() ? 1 : 0) ||
+            (storage_.compressed() && (header.value_bits != storage_.value_bits || header.block_shift != storage_.block_shift)) ||
+            file_size != header.data_offset + bytes) {
+            return false;
+        }
+        for (size_t i = 0; i < tiles_.size(); ++i) {
+            if (header.tiles[i] != tiles_[i]) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+#ifdef PATTERN_DATABASE_USE_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) != 0 || static_cast<uint64_t>(st.st_size) < sizeof(PatternFileHeader)) {
+        ::close(fd);
+        return false;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    // 不加 MAP_POPULATE：只读入文件头，表页在查表时按需调入
+    void* base = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        return false;
+    }
+    PatternFileHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    if (!header_matches(header, size)) {
+        spdlog::default_logger()->warn("Ignoring pattern database {} with mismatched header.", path);
+        ::munmap(base, size);
+        return false;
+    }
+    mapping_ = base;
+    mapping_size_ = size;
+    table_ = static_cast<const uint8_t*>(base) + header.data_offset;
+    advise_mapping(const_cast<uint8_t*>(table_), static_cast<size_t>(bytes));
+#else
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    PatternFileHeader header;
+    in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    std::error_code ec;
+    uint64_t size = std::filesystem::file_size(path, ec);
+    if (!in || ec || !header_matches(header, size)) {
+        spdlog::default_logger()->warn("Ignoring pattern database {} with mismatched header.", path);
+        return false;
+    }
+    owned_table_.resize(bytes);
+    in.seekg(header.data_offset);
+    in.read(reinterpret_cast<char*>(owned_table_.data()), static_cast<std::streamsize>(bytes));
+    if (!in) {
+        owned_table_.clear();
+        return false;
+    }
+    table_ = owned_table_.data();
+#endif
+    entry_count_ = entries;
+    table_bytes_ = bytes;
+    max_value_ = static_cast<int>(header.max_value);
+
+    if (env_flag("NUMBER_SLIDER_PDB_VERIFY")) {
+        auto start = std::chrono::steady_clock::now();
+        const uint64_t actual = checksum();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (actual != header.checksum) {
+            spdlog::default_logger()->warn("Pattern database {} fails its checksum ({:016x} != {:016x}); ignoring it.", path, actual, header.checksum);
+#ifdef PATTERN_DATABASE_USE_MMAP
+            ::munmap(mapping_, mapping_size_);
+            mapping_ = nullptr;
+            mapping_size_ = 0;
+#endif
+            owned_table_.clear();
+            table_ = nullptr;
+            entry_count_ = 0;
+            table_bytes_ = 0;
+            return false;
+        }
+        spdlog::default_logger()->info("Verified pattern database {} checksum in {:.2f} seconds.", path, elapsed.count());
+    }
+    spdlog::default_logger()->info("Loaded pattern database {} ({} entries, {} MB, max value {}).", path, entry_count_, table_bytes_ >> 20, max_value_);
+    return true;
+}
+
+bool PatternDatabase::write_file(const std::string& path) const {
+    std::error_code ec;
+    std::filesystem::path target(path);
+    if (target.has_parent_path()) {
+        std::filesystem::create_directories(target.parent_path(), ec);
+    }
+
+    PatternFileHeader header{};
+    std::memcpy(header.magic, kPatternMagic, sizeof(kPatternMagic));
+    header.version = kPatternVersion;
+    header.data_offset = kPatternDataOffset;
+    header.rows = static_cast<uint32_t>(rows_);
+    header.cols = static_cast<uint32_t>(cols_);
+    header.solve_type = static_cast<uint32_t>(type_);
+    header.ranking = kRankingPartialLexicographic;
+    header.tile_count = static_cast<uint32_t>(tiles_.size());
+    header.max_value = static_cast<uint32_t>(max_value_);
+    header.entry_count = entry_count_;
+    header.checksum = checksum();
+    for (size_t i = 0; i < tiles_.size(); ++i) {
+        header.tiles[i] = static_cast<uint8_t>(tiles_[i]);
+    }
+    if (storage_.compressed()) {
+        header.encoding = 1;
+        header.value_bits = static_cast<uint8_t>(storage_.value_bits);
+        header.block_shift = static_cast<uint8_t>(storage_.block_shift);
+    }
+    std::vector<char> padding(kPatternDataOffset - sizeof(header), 0);
+
+    const std::string temp_path = path + ".tmp";
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+        out.write(reinterpret_cast<const char*>(table_), static_cast<std::streamsize>(table_bytes_));
+        if (!out) {
+            return false;
+        }
+    }
+    std::filesystem::rename(temp_path, target, ec);
+    return !ec;
+}
@@ -0,0 +1,177 @@
+#ifndef PATTERN_DATABASE_HPP
+#define PATTERN_DATABASE_HPP
+
+#include "PermutationRank.hpp"
+#include "SolveType.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// 模式数据库的存储方式。
+// 原始表每项 1 字节存表值。压缩表不存表值本身，而存它高出模式数字曼哈顿距离的部分：
+// 相邻交换模式下每次移动模式数字恰好改变曼哈顿距离 1 且计 1 步，表值与曼哈顿距离同奇偶，存 (表值 - 曼哈顿距离) / 2，
+// 4x4 的 6-6-3、7-8 划分中都不超过 15，4 位即可无损保存，2 位时更大的值截断为 3；批量位移模式下直接存表值并截断。
+// 另外可以把相邻 2^block_shift 个排名合并为一项、取其最小值（排名按最后几个数字的位置连续变化，
+// 减去各自的曼哈顿距离后同一块内的偏移相差不大）。截断和取最小值都只会使表值变小，仍是可采纳的下界。
+struct PatternStorage {
+    static constexpr int kMaxBlockShift = 6;
+
+    int value_bits = 8;  // 每项的位数：8、4 或 2
+    int block_shift = 0; // 合并的排名块大小为 2^block_shift
+
+    bool compressed() const { return value_bits != 8 || block_shift != 0; }
+    // "byte"、"4bit"、"2bit-min4" 等，与 parse 接受的写法一致
+    std::string name() const;
+    // 按 entries 个排名存储时的表字节数
+    uint64_t table_bytes(uint64_t entries) const;
+
+    // 解析 "byte"、"4bit"、"2bit"，可再接 "-min<B>"（B 为 2 到 64 的 2 的幂），如 "4bit-min4"；无法解析时返回 false
+    static bool parse(const std::string& spec, PatternStorage& storage);
+};
+
+// 加性不相交模式数据库（Korf & Felner）。
+// 一个模式是若干数字的集合，抽象状态只记这些数字所在的格子，按 rank_partial 稠密排名后用平坦数组 O(1) 查表。
+// 表值为把模式数字移到目标位置所需的、移动模式数字的最少步数：空格与非模式数字交换不计代价，
+// 所以各模式互不相交时，它们的表值之和仍是可采纳的下界。
+// 批量位移模式下一次位移只要推动了模式数字就计 1 步，同一次位移可能同时推动几个模式的数字，各模式的表值只能取最大值。
+//
+// 构造时对 (模式位置, 空格位置) 做逐层同步的并行 0-1 BFS：空格在非模式格子间的移动不计代价，
+// 同一连通块内的空格位置一次性标记；每个模式位置的表值为它第一次被访问时的层数。
+// 空格位置只在非模式格子中排名，已访问集合与两层 frontier 都是 (模式位置数 x 非模式格子数) 位的位图，
+// 4x4 的 8 数字模式共约 1.5 GB 位图加 500 MB 表。
+// 表由 pdb_builder 离线构造，写入环境变量 NUMBER_SLIDER_PDB_DIR 指定的目录（默认为当前目录下的 pdbs/），求解时以只读 mmap 映射该文件，
+// 启动时只校验文件头，表页在第一次查到时才由页缓存调入，多个进程共享同一份物理内存。
+// 文件头记录形状、求解类型、模式数字、排名方式与表数据的校验和，表数据按页对齐。
+// 表也可以压缩存储（见 PatternStorage），压缩表由原始表换算并单独成文件。
+// 环境变量 NUMBER_SLIDER_PDB_ADVICE 给出映射的 madvise 提示（逗号分隔的 random、willneed、hugepage，默认 random），
+// NUMBER_SLIDER_PDB_VERIFY=1 时加载时校验整张表（需要读入整个文件）。
+class PatternDatabase {
+public:
+    static constexpr uint8_t kUnreached = 0xFF;
+    static constexpr uint64_t kMaxEntries = 1ULL << 32; // 表项数上限，超过时拒绝构造
+
+    // 某一形状、求解类型下由 tiles 构成的模式，按 storage 存储，进程内缓存，线程安全；
+    // 只映射已有文件：压缩表文件不存在时由已映射的原始表在内存中换算；都没有时返回 nullptr 并提示用 pdb_builder 构造。
+    // 求解过程中从不构造表、不写文件，调用方自行退回其他启发函数
+    static std::shared_ptr<const PatternDatabase> get(int rows, int cols, SolveType type, const std::vector<int>& tiles,
+                                                      PatternStorage storage = {});
+
+    // 只构造、不读写文件；模式过大时返回 nullptr
+    static std::shared_ptr<PatternDatabase> build(int rows, int cols, SolveType type, const std::vector<int>& tiles);
+
+    // 把原始表换算为 storage 指定的压缩表，不读写文件
+    static std::shared_ptr<PatternDatabase> compress(const PatternDatabase& raw, PatternStorage storage);
+
+    PatternDatabase(const PatternDatabase&) = delete;
+    PatternDatabase& operator=(const PatternDatabase&) = delete;
+    ~PatternDatabase();
+
+    static std::string file_name(int rows, int cols, SolveType type, const std::vector<int>& tiles, PatternStorage storage = {});
+    static std::string file_path(int rows, int cols, SolveType type, const std::vector<int>& tiles, PatternStorage storage = {});
+
+    // 构造所需的大致内存（位图 + 表）
+    static uint64_t build_memory_bytes(int rows, int cols, int tile_count);
+
+    bool write_file(const std::string& path) const;
+
+    int rows() const { return rows_; }
+    int cols() const { return cols_; }
+    SolveType type() const { return type_; }
+    const std::vector<int>& tiles() const { return tiles_; }
+    PatternStorage storage() const { return storage_; }
+    uint64_t entry_count() const { return entry_count_; } // 模式位置数，与存储方式无关
+    uint64_t table_bytes() const { return table_bytes_; }
+    int max_value() const { return max_value_; }
+    uint64_t checksum() const; // 表数据的 64 位 FNV-1a 校验和（按 8 字节字计算）
+
+    // positions[i] 为 tiles()[i] 当前所在的格子
+    int lookup(const uint8_t* positions) const {
+        const int k = static_cast<int>(tiles_.size());
+        const uint64_t rank = rank_partial(positions, k, rows_ * cols_);
+        if (!storage_.compressed()) {
+            return table_[rank];
+        }
+        const uint64_t index = rank >> storage_.block_shift;
+        int code;
+        if (storage_.value_bits == 8) {
+            code = table_[index];
+        } else if (storage_.value_bits == 4) {
+            code = (table_[index >> 1] >> ((index & 1) * 4)) & 0xF;
+        } else {
+            code = (table_[index >> 2] >> ((index & 3) * 2)) & 0x3;
+        }
+        if (offset_scale_ == 1) {
+            return code;
+        }
+        int base = 0;
+        for (int i = 0; i < k; ++i) {
+            base += goal_distance_[i * 64 + positions[i]];
+        }
+        return base + offset_scale_ * code;
+    }
+
+    // 把 lookup 拆成两步：probe 算出表项所在的字节（并可预取其缓存行），value 读出表值，value(probe(p)) == lookup(p)。
+    // 批量处理多个子节点时先对所有查表调用 probe，再依次 value，各次访存的延迟互相重叠。
+    // Probe 不带默认初始化，批量查表时在栈上开的数组不必逐项清零
+    struct Probe {
+        const uint8_t* address; // 表项所在的字节
+        uint8_t shift;          // 表项在该字节中的位移
+        uint8_t mask;
+        int base;               // 压缩表叠加的模式数字曼哈顿距离之和，其余为 0
+    };
+
+    Probe probe(const uint8_t* positions) const {
+        const int k = static_cast<int>(tiles_.size());
+        const uint64_t rank = rank_partial(positions, k, rows_ * cols_);
+        Probe result{table_ + rank, 0, 0xFF, 0};
+        if (!storage_.compressed()) {
+            return result;
+        }
+        const uint64_t index = rank >> storage_.block_shift;
+        const int entries_per_byte_log = storage_.value_bits == 8 ? 0 : (storage_.value_bits == 4 ? 1 : 2);
+        result.address = table_ + (index >> entries_per_byte_log);
+        result.shift = static_cast<uint8_t>((index & ((1u << entries_per_byte_log) - 1)) * storage_.value_bits);
+        result.mask = static_cast<uint8_t>((1u << storage_.value_bits) - 1);
+        if (offset_scale_ != 1) {
+            for (int i = 0; i < k; ++i) {
+                result.base += goal_distance_[i * 64 + positions[i]];
+            }
+        }
+        return result;
+    }
+
+    static void prefetch(const Probe& probe) { __builtin_prefetch(probe.address); }
+
+    // 原始表与批量位移的压缩表 offset_scale_ 为 1、base 为 0，表值就是存储的编码
+    int value(const Probe& probe) const { return probe.base + offset_scale_ * ((*probe.address >> probe.shift) & probe.mask); }
+
+private:
+    PatternDatabase(int rows, int cols, SolveType type, const std::vector<int>& tiles, PatternStorage storage = {});
+
+    void run_bfs();
+    bool map_file(const std::string& path);
+
+    int rows_;
+    int cols_;
+    SolveType type_;
+    std::vector<int> tiles_;
+    PatternStorage storage_;
+    int offset_scale_ = 1;              // 压缩表中偏移的单位，相邻交换为 2（叠加在曼哈顿距离上）
+    std::vector<uint8_t> goal_distance_; // [i * 64 + 格子]：tiles_[i] 在该格子时到目标格子的曼哈顿距离
+    uint64_t entry_count_ = 0;
+    uint64_t table_bytes_ = 0;
+    int max_value_ = 0;
+
+    const uint8_t* table_ = nullptr; // [rank_partial(positions)]，指向映射的文件或 owned_table_
+    std::vector<uint8_t> owned_table_; // 本进程刚构造的表
+    void* mapping_ = nullptr;
+    size_t mapping_size_ = 0;
+};
+
+// 解析模式划分：空串为该形状的默认划分；也可以是常用划分的名称（4x4 的 "6-6-3"、"7-8"，3x5 的 "6-8"，
+// 4x5 的 "6-6-7"，5x5 的 "6-6-6-6"），或显式列出的数字，模式之间用 '/' 分隔、数字之间用 ',' 分隔，如 "1,2,5,6/3,4,7,8"。
+// 数字必须在 1..N*M-1 内且互不重复；无法解析或没有对应划分时返回空
+std::vector<std::vector<int>> resolve_partition(int rows, int cols, const std::string& spec);
+
+#endif // PATTERN_DATABASE_HPP
@@ -0,0 +1,186 @@
+#ifndef PERMUTATION_RANK_HPP
+#define PERMUTATION_RANK_HPP
+
+#include <array>
+#include <cstdint>
+
+// 排列的字典序排名 / 反排名。
+// 把棋盘状态映射为稠密整数，使关闭表、模式数据库和距离表可以用平坦数组或位图代替哈希表。
+//
+// Lehmer 码的每一位 d_i = (s_i 之前未出现过的、比 s_i 小的值的个数)，用“已出现值”位掩码加 popcount 在 O(1) 内得到，
+// 阶乘由编译期表给出，因此排名和反排名都是 O(格子数) 的表查找与位运算，3x3、3x4、4x4 均不超过 16 次迭代。
+
+constexpr int kRankMaxCells = 20; // 20! < 2^63，超过 20 格的棋盘无法用 64 位整数排名
+
+constexpr std::array<uint64_t, kRankMaxCells + 1> make_factorials() {
+    std::array<uint64_t, kRankMaxCells + 1> f{};
+    f[0] = 1;
+    for (int i = 1; i <= kRankMaxCells; ++i) {
+        f[i] = f[i - 1] * static_cast<uint64_t>(i);
+    }
+    return f;
+}
+
+inline constexpr auto kFactorials = make_factorials();
+
+inline int popcount64(uint64_t x) {
+    return __builtin_popcountll(x);
+}
+
+// 在位掩码 bits 中选出第 k 个 (从 0 开始) 为 1 的位
+inline int select_bit(uint64_t bits, int k) {
+    for (; k > 0; --k) {
+        bits &= bits - 1;
+    }
+    return __builtin_ctzll(bits);
+}
+
+// 可解状态所需的逆序数奇偶性：空格目标位置在右下角。
+// 列数为奇数时，竖直移动改变偶数个逆序，逆序数必须为偶数；
+// 列数为偶数时，竖直移动同时改变逆序数奇偶和空格行号，逆序数 + 空格到最后一行的距离必须为偶数。
+inline int solvable_inversion_parity(int rows, int cols, int blank_row) {
+    return (cols % 2 == 1) ? 0 : ((rows - 1 - blank_row) & 1);
+}
+
+// tiles 为 0..N*M-1 的排列（0 为空格）时，判断该棋盘能否到达目标状态
+inline bool is_solvable(const uint8_t* tiles, int rows, int cols) {
+    uint64_t seen = 0;
+    int inversions = 0;
+    int blank = 0;
+    for (int pos = 0; pos < rows * cols; ++pos) {
+        int value = tiles[pos];
+        if (value == 0) {
+            blank = pos;
+            continue;
+        }
+        inversions += popcount64(seen >> value); // 之前出现过的、比 value 大的数字
+        seen |= 1ULL << value;
+    }
+    return (inversions & 1) == solvable_inversion_parity(rows, cols, blank / cols);
+}
+
+// 某一形状下可解棋盘的稠密排名，值域为 [0, (N*M)!/2)。
+// 排名 = 空格位置 * ((N*M-1)!/2) + (其余数字按行优先顺序构成的排列的字典序排名 / 2)。
+// 字典序上相邻的 2k 与 2k+1 只差最后两个数字的交换，逆序数奇偶相反，而空格位置固定时可解性只取决于该奇偶，
+// 所以每对中恰有一个可解，除以 2 后可解状态与整数一一对应。
+class BoardRanker {
+public:
+    BoardRanker(int rows, int cols)
+        : rows_(rows), cols_(cols), cells_(rows * cols),
+          per_blank_(kFactorials[rows * cols - 1] / 2) {}
+
+    static bool supports(int rows, int cols) {
+        return rows * cols >= 3 && rows * cols <= kRankMaxCells;
+    }
+
+    int cells() const { return cells_; }
+
+    // 可解状态总数 (N*M)!/2
+    uint64_t state_count() const { return per_blank_ * static_cast<uint64_t>(cells_); }
+
+    // tiles: 按行优先排列的数字，0 代表空格；要求棋盘可解
+    uint64_t rank(const uint8_t* tiles) const {
+        uint64_t seen = 0;
+        uint64_t tile_rank = 0;
+        int blank = 0;
+        int i = 0; // 已处理的数字个数
+        for (int pos = 0; pos < cells_; ++pos) {
+            int value = tiles[pos];
+            if (value == 0) {
+                blank = pos;
+                continue;
+            }
+            uint64_t below = (1ULL << value) - 2; // 1..value-1
+            int digit = value - 1 - popcount64(seen & below);
+            tile_rank += static_cast<uint64_t>(digit) * kFactorials[cells_ - 2 - i];
+            seen |= 1ULL << value;
+            ++i;
+        }
+        return static_cast<uint64_t>(blank) * per_blank_ + (tile_rank >> 1);
+    }
+
+    template <typename BoardT>
+    uint64_t rank_board(const BoardT& board) const {
+        std::array<uint8_t, kRankMaxCells> tiles{};
+        for (int pos = 0; pos < cells_; ++pos) {
+            tiles[pos] = static_cast<uint8_t>(board.at(pos));
+        }
+        return rank(tiles.data());
+    }
+
+    // 反排名：写出 cells() 个数字到 tiles
+    void unrank(uint64_t r, uint8_t* tiles) const {
+        const int n = cells_ - 1; // 数字个数
+        int blank = static_cast<int>(r / per_blank_);
+        uint64_t tile_rank = (r % per_blank_) << 1;
+
+        std::array<int, kRankMaxCells> digits{};
+        int parity = 0;
+        for (int i = 0; i < n; ++i) {
+            uint64_t weight = kFactorials[n - 1 - i];
+            digits[i] = static_cast<int>(tile_rank / weight);
+            tile_rank %= weight;
+            parity ^= digits[i] & 1;
+        }
+        // 2k 与 2k+1 只差倒数第二位 Lehmer 码，选出逆序数奇偶符合可解条件的那一个
+        if (parity != solvable_inversion_parity(rows_, cols_, blank / cols_)) {
+            digits[n - 2] = 1;
+        }
+
+        uint64_t unused = ((1ULL << n) - 1) << 1; // 值 1..n
+        int i = 0;
+        for (int pos = 0; pos < cells_; ++pos) {
+            if (pos == blank) {
+                tiles[pos] = 0;
+                continue;
+            }
+            int value = select_bit(unused, digits[i++]);
+            unused &= ~(1ULL << value);
+            tiles[pos] = static_cast<uint8_t>(value);
+        }
+    }
+
+private:
+    int rows_;
+    int cols_;
+    int cells_;
+    uint64_t per_blank_; // 每个空格位置对应的可解状态数 (N*M-1)!/2
+};
+
+// 部分排列（k 个数字在 n 个格子中的位置）的字典序排名，值域为 [0, n!/(n-k)!)，供模式数据库使用。
+// positions[i] 为第 i 个模式数字所在的格子。
+inline uint64_t partial_permutation_count(int n, int k) {
+    uint64_t count = 1;
+    for (int i = 0; i < k; ++i) {
+        count *= static_cast<uint64_t>(n - i);
+    }
+    return count;
+}
+
+inline uint64_t rank_partial(const uint8_t* positions, int k, int n) {
+    uint64_t used = 0;
+    uint64_t r = 0;
+    for (int i = 0; i < k; ++i) {
+        int pos = positions[i];
+        int digit = pos - popcount64(used & ((1ULL << pos) - 1));
+        r = r * static_cast<uint64_t>(n - i) + static_cast<uint64_t>(digit);
+        used |= 1ULL << pos;
+    }
+    return r;
+}
+
+inline void unrank_partial(uint64_t r, int k, int n, uint8_t* positions) {
+    std::array<int, 64> digits{};
+    for (int i = k - 1; i >= 0; --i) {
+        digits[i] = static_cast<int>(r % static_cast<uint64_t>(n - i));
+        r /= static_cast<uint64_t>(n - i);
+    }
+    uint64_t unused = (n == 64) ? ~0ULL : ((1ULL << n) - 1);
+    for (int i = 0; i < k; ++i) {
+        int pos = select_bit(unused, digits[i]);
+        unused &= ~(1ULL << pos);
+        positions[i] = static_cast<uint8_t>(pos);
+    }
+}
+
+#endif // PERMUTATION_RANK_HPP
@@ -0,0 +1,50 @@
+#include "PuzzleAnalysis.hpp"
+#include "HeuristicKernels.hpp"
+#include "PermutationRank.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+PuzzleAnalysis analyze_puzzle(int N, int M, const std::vector<int>& tiles, SolveType type) {
+    PuzzleAnalysis analysis;
+    const int cells = N * M;
+    if (static_cast<int>(tiles.size()) != cells || cells > kKernelMaxCells) {
+        return analysis;
+    }
+
+    UnpackedTiles unpacked{};
+    uint64_t seen = 0;
+    for (int pos = 0; pos < cells; ++pos) {
+        int value = tiles[pos];
+        if (value < 0 || value >= cells || (seen >> value & 1)) {
+            return analysis;
+        }
+        seen |= 1ULL << value;
+        unpacked[pos] = static_cast<uint8_t>(value);
+    }
+    analysis.is_permutation = true;
+
+    if (N == 1 || M == 1) {
+        // 单行或单列的棋盘上数字之间的顺序永远不变，只有按顺序排列时才可解
+        int previous = 0;
+        analysis.solvable = true;
+        for (int pos = 0; pos < cells; ++pos) {
+            if (unpacked[pos] == 0) continue;
+            analysis.solvable = analysis.solvable && unpacked[pos] > previous;
+            previous = unpacked[pos];
+        }
+    } else {
+        analysis.solvable = is_solvable(unpacked.data(), N, M);
+    }
+
+    BoardEvaluation evaluation = evaluate_board(unpacked, N, M);
+    analysis.solved = evaluation.is_goal;
+    analysis.manhattan = evaluation.manhattan;
+    if (type == SolveType::AdjacentSwap) {
+        analysis.lower_bound = evaluation.manhattan;
+    } else {
+        int longest_shift = std::max(N, M) - 1;
+        analysis.lower_bound = longest_shift > 0 ? (evaluation.manhattan + longest_shift - 1) / longest_shift : 0;
+    }
+    return analysis;
+}
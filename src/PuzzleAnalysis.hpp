@@ -0,0 +1,23 @@
+#ifndef PUZZLE_ANALYSIS_HPP
+#define PUZZLE_ANALYSIS_HPP
+
+#include "SolveType.hpp"
+#include <vector>
+
+// 搜索前的实例预分析，全部为 O(N*M)，在启动任何搜索线程之前完成：
+// 非法输入和不可解的棋盘（随机输入中占一半）直接拒绝，不必穷尽可达的半个状态空间；
+// 已还原的棋盘直接作答；并给出最优解步数的下界。
+struct PuzzleAnalysis {
+    bool is_permutation = false; // 输入恰为 0..N*M-1 的一个排列
+    bool solvable = false;       // 能否到达目标状态
+    bool solved = false;         // 已是目标状态
+    int manhattan = 0;           // 曼哈顿距离之和
+    // 最优解步数的下界。相邻交换每步只让一个数字移动一格，下界即曼哈顿距离；
+    // 批量位移每步至多让 max(N, M) - 1 个数字各移动一格，下界为 ceil(曼哈顿距离 / (max(N, M) - 1))
+    int lower_bound = 0;
+};
+
+// 要求 N * M 不超过 64
+PuzzleAnalysis analyze_puzzle(int N, int M, const std::vector<int>& tiles, SolveType type);
+
+#endif // PUZZLE_ANALYSIS_HPP
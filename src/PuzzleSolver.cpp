@@ -1,13 +1,224 @@
 #include "PuzzleSolver.hpp"
+#include "DistanceOracle.hpp"
+#include "PuzzleAnalysis.hpp"
 #include <iostream>
 #include <thread>
 #include <chrono>
 #include <algorithm>
+#include <array>
 #include <sstream>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
 
 #include <tbb/task_group.h>
+#include <tbb/task_arena.h>
+#include <tbb/parallel_for.h>
 
-std::vector<Solution> PuzzleSolver::solve(const Board& initial_board, SolveType type, int num_solutions_to_find, int num_threads, int time_limit_seconds) {
+// 沿完全距离表下降求解小棋盘，不经过 A*；initial_tiles 已通过预分析，是可解的排列
+static std::vector<Solution> solve_with_oracle(const DistanceOracle& oracle, const std::vector<int>& initial_tiles, int num_solutions_to_find) {
+    auto start_time = std::chrono::steady_clock::now();
+    std::vector<Solution> solutions;
+    for (auto& path : oracle.optimal_paths(initial_tiles, num_solutions_to_find)) {
+        int cost = static_cast<int>(path.size()) - 1;
+        solutions.push_back({cost, std::move(path)});
+    }
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start_time;
+    spdlog::default_logger()->info("Answered from the {}x{} distance oracle in {:.1f} us.", oracle.rows(), oracle.cols(), elapsed.count());
+    return solutions;
+}
+
+// 启发函数流水线各组件的抽样计数：计算、跳过、证明可剪枝与抬高启发值的节点比例，以及每次计算的平均耗时
+template <size_t Count>
+static void log_pipeline_stats(const PipelineStats& stats, const std::array<const char*, Count>& names) {
+    const long long nodes = stats.nodes.load();
+    if (nodes == 0) {
+        return;
+    }
+    for (size_t i = 0; i < Count; ++i) {
+        const PipelineStats::Component& component = stats.components[i];
+        const long long evaluations = component.evaluations.load();
+        spdlog::default_logger()->info("  {}: evaluated {:.1f}%, skipped {:.1f}%, proved pruning {:.1f}%, raised h {:.1f}% of nodes; {:.0f} ns per evaluation.",
+                                       names[i], 100.0 * evaluations / nodes, 100.0 * component.skipped.load() / nodes,
+                                       100.0 * component.pruned.load() / nodes, 100.0 * component.raised.load() / nodes,
+                                       evaluations > 0 ? static_cast<double>(component.nanoseconds.load()) / evaluations : 0.0);
+    }
+}
+
+std::vector<Solution> PuzzleSolver::solve(int N, int M, const std::vector<int>& initial_tiles, SolveType type, int num_solutions_to_find, int num_threads, int time_limit_seconds,
+                                          const SolverOptions& options) {
+    if (N * M > Board64::kMaxCells) {
+        spdlog::default_logger()->error("Board {}x{} has {} cells, more than the supported maximum of {}.", N, M, N * M, Board64::kMaxCells);
+        return {};
+    }
+
+    // 预分析：在启动任何搜索之前拒绝非法或不可解的输入，处理已还原的棋盘，并报告下界
+    PuzzleAnalysis analysis = analyze_puzzle(N, M, initial_tiles, type);
+    if (!analysis.is_permutation) {
+        spdlog::default_logger()->error("Tiles must be a permutation of 0..{}.", N * M - 1);
+        return {};
+    }
+    if (!analysis.solvable) {
+        spdlog::default_logger()->info("Board is not solvable; skipping search.");
+        return {};
+    }
+    if (analysis.solved) {
+        spdlog::default_logger()->info("Board is already solved.");
+        return {Solution{0, {initial_tiles}}};
+    }
+    spdlog::default_logger()->info("Pre-analysis: Manhattan distance {}, optimal solution needs at least {} moves.", analysis.manhattan, analysis.lower_bound);
+
+    // 不超过 12 格的形状整个状态空间都在完全距离表中，已由 oracle_builder 构造时直接查表，否则照常搜索
+    if (options.use_distance_oracle && DistanceOracle::supports(N, M)) {
+        if (auto oracle = DistanceOracle::get(N, M, type)) {
+            return solve_with_oracle(*oracle, initial_tiles, num_solutions_to_find);
+        }
+        spdlog::default_logger()->info("No {}x{} distance oracle at {}; searching instead. Build it offline with oracle_builder.", N, M,
+                                       DistanceOracle::file_path(N, M, type));
+    }
+
+    // 常见形状使用编译期特化的 Board<N, M>，行列运算和循环边界都是常量
+    if (N == 2 && M == 2) return run_search<Board<2, 2>>(N, M, initial_tiles, type, num_solutions_to_find, num_threads, time_limit_seconds, options);
+    if (N == 3 && M == 3) return run_search<Board<3, 3>>(N, M, initial_tiles, type, num_solutions_to_find, num_threads, time_limit_seconds, options);
+    if (N == 3 && M == 4) return run_search<Board<3, 4>>(N, M, initial_tiles, type, num_solutions_to_find, num_threads, time_limit_seconds, options);
+    if (N == 4 && M == 3) return run_search<Board<4, 3>>(N, M, initial_tiles, type, num_solutions_to_find, num_threads, time_limit_seconds, options);
+    if (N == 4 && M == 4) return run_search<Board<4, 4>>(N, M, initial_tiles, type, num_solutions_to_find, num_threads, time_limit_seconds, options);
+    if (N == 5 && M == 5) return run_search<Board<5, 5>>(N, M, initial_tiles, type, num_solutions_to_find, num_threads, time_limit_seconds, options);
+
+    // 其余形状走运行期尺寸的通用路径，选择能容纳该棋盘的最窄打包表示
+    if (Board16::fits(N, M)) {
+        return run_search<Board16>(N, M, initial_tiles, type, num_solutions_to_find, num_threads, time_limit_seconds, options);
+    }
+    if (Board25::fits(N, M)) {
+        return run_search<Board25>(N, M, initial_tiles, type, num_solutions_to_find, num_threads, time_limit_seconds, options);
+    }
+    return run_search<Board64>(N, M, initial_tiles, type, num_solutions_to_find, num_threads, time_limit_seconds, options);
+}
+
+template <typename BoardT>
+std::vector<Solution> PuzzleSolver::run_search(int N, int M, const std::vector<int>& initial_tiles, SolveType type, int num_solutions_to_find, int num_threads, int time_limit_seconds,
+                                               const SolverOptions& options) {
+    BoardT initial_board(N, M, initial_tiles);
+    if (options.heuristic == HeuristicKind::BlockCrossing) {
+        if (type == SolveType::BlockShift) {
+            return run_engine(initial_board, type, num_solutions_to_find, num_threads, time_limit_seconds, options, BlockCrossingHeuristic());
+        }
+        // 相邻交换下曼哈顿距离不小于穿越下界
+        return run_engine(initial_board, type, num_solutions_to_find, num_threads, time_limit_seconds, options, ManhattanHeuristic());
+    }
+    if (type == SolveType::BlockShift && options.heuristic != HeuristicKind::PatternDatabase) {
+        spdlog::default_logger()->warn("Manhattan-based heuristics can overestimate under block shifts; the solution may not be optimal. "
+                                       "Use --heuristic=block-crossing or --heuristic=pdb for optimal block-shift solutions.");
+    }
+    if (options.heuristic == HeuristicKind::WalkingDistance) {
+        WalkingDistanceHeuristic heuristic(N, M, options.walking_distance_linear_conflict);
+        if (heuristic.supported()) {
+            spdlog::default_logger()->info("Walking distance maxed with linear conflict: {}.", heuristic.max_with_linear_conflict);
+            return run_engine(initial_board, type, num_solutions_to_find, num_threads, time_limit_seconds, options, heuristic);
+        }
+        spdlog::default_logger()->warn("Walking distance is not available for {}x{}; falling back to linear conflict.", N, M);
+        return run_engine(initial_board, type, num_solutions_to_find, num_threads, time_limit_seconds, options, LinearConflictHeuristic());
+    }
+    if (options.heuristic == HeuristicKind::PatternDatabase) {
+        // 每种求解类型使用按其移动规则构造的表；批量位移的表由 PatternDatabaseHeuristic 取最大值
+        std::vector<std::vector<int>> groups = resolve_partition(N, M, options.pattern_partition);
+        std::vector<std::shared_ptr<const PatternDatabase>> databases;
+        for (const std::vector<int>& tiles : groups) {
+            databases.push_back(PatternDatabase::get(N, M, type, tiles, options.pattern_storage));
+        }
+        bool usable = !databases.empty() && databases.size() <= static_cast<size_t>(PatternDatabaseHeuristic::kMaxGroups) &&
+                      std::find(databases.begin(), databases.end(), nullptr) == databases.end();
+        if (usable) {
+            spdlog::default_logger()->info("Pattern database partition: {} groups, {} storage.", databases.size(), options.pattern_storage.name());
+            if (options.pattern_reflection && N != M) {
+                spdlog::default_logger()->warn("Reflected pattern lookups need a square board; disabled for {}x{}.", N, M);
+            }
+            PatternDatabaseHeuristic heuristic(std::move(databases), options.pattern_reflection && N == M, options.pattern_dual);
+            auto run_pipeline = [&](const auto& pipeline) {
+                spdlog::default_logger()->info("Heuristic pipeline: {}.", pipeline.describe());
+                std::vector<Solution> solutions = run_engine(initial_board, type, num_solutions_to_find, num_threads, time_limit_seconds, options, pipeline);
+                log_pipeline_stats(*pipeline.stats, pipeline.kComponentNames);
+                return solutions;
+            };
+            std::vector<Solution> solutions;
+            if (options.pattern_prefilter == PatternPrefilter::None) {
+                solutions = run_engine(initial_board, type, num_solutions_to_find, num_threads, time_limit_seconds, options, heuristic);
+            } else if (type == SolveType::BlockShift) {
+                solutions = run_pipeline(HeuristicPipeline<MaxCombine, BlockCrossingHeuristic, PatternDatabaseHeuristic>(BlockCrossingHeuristic(), heuristic));
+            } else if (options.pattern_prefilter == PatternPrefilter::Manhattan) {
+                solutions = run_pipeline(HeuristicPipeline<MaxCombine, ManhattanHeuristic, PatternDatabaseHeuristic>(ManhattanHeuristic(), heuristic));
+            } else if (options.pattern_prefilter == PatternPrefilter::WalkingDistance && WalkingDistanceHeuristic(N, M, false).supported()) {
+                solutions = run_pipeline(HeuristicPipeline<MaxCombine, WalkingDistanceHeuristic, PatternDatabaseHeuristic>(WalkingDistanceHeuristic(N, M, false), heuristic));
+            } else {
+                if (options.pattern_prefilter == PatternPrefilter::WalkingDistance) {
+                    spdlog::default_logger()->warn("Walking distance is not available for {}x{}; prefiltering with linear conflict.", N, M);
+                }
+                solutions = run_pipeline(HeuristicPipeline<MaxCombine, LinearConflictHeuristic, PatternDatabaseHeuristic>(LinearConflictHeuristic(), heuristic));
+            }
+            if (heuristic.stats && heuristic.stats->nodes.load() > 0) {
+                const PatternDatabaseHeuristic::Stats& stats = *heuristic.stats;
+                const double nodes = static_cast<double>(stats.nodes.load());
+                spdlog::default_logger()->info("Pattern lookups per node (1 in 64 sampled): regular {:.2f}, reflected {:.2f}, dual {:.2f} ({:.1f}% of nodes reuse the parent's dual value).",
+                                               stats.lookups.load() / nodes, stats.reflected_lookups.load() / nodes, stats.dual_lookups.load() / nodes,
+                                               100.0 * stats.dual_reused.load() / nodes);
+                spdlog::default_logger()->info("Reflection raised h at {:.1f}% of nodes, dual at {:.1f}%.",
+                                               100.0 * stats.reflected_raised.load() / nodes, 100.0 * stats.dual_raised.load() / nodes);
+            }
+            return solutions;
+        }
+        if (type == SolveType::BlockShift) {
+            spdlog::default_logger()->warn("No usable pattern partition '{}' for {}x{}; falling back to block crossings.", options.pattern_partition, N, M);
+            return run_engine(initial_board, type, num_solutions_to_find, num_threads, time_limit_seconds, options, BlockCrossingHeuristic());
+        }
+        spdlog::default_logger()->warn("No usable pattern partition '{}' for {}x{}; falling back to linear conflict.", options.pattern_partition, N, M);
+        return run_engine(initial_board, type, num_solutions_to_find, num_threads, time_limit_seconds, options, LinearConflictHeuristic());
+    }
+    if (options.heuristic == HeuristicKind::LinearConflict) {
+        return run_engine(initial_board, type, num_solutions_to_find, num_threads, time_limit_seconds, options, LinearConflictHeuristic());
+    }
+    return run_engine(initial_board, type, num_solutions_to_find, num_threads, time_limit_seconds, options, ManhattanHeuristic());
+}
+
+template <typename BoardT, typename Heuristic>
+std::vector<Solution> PuzzleSolver::run_engine(const BoardT& initial_board, SolveType type, int num_solutions_to_find, int num_threads, int time_limit_seconds,
+                                               const SolverOptions& options, const Heuristic& heuristic) {
+    spdlog::default_logger()->info("Heuristic: {}", Heuristic::kName);
+    if (options.engine == SearchEngine::IDAStar) {
+        IDAStarSearch<BoardT, Heuristic> search(heuristic, options.batch_children, options.pathmax);
+        return search.run(initial_board, type, num_solutions_to_find, num_threads, time_limit_seconds);
+    }
+    AStarSearch<BoardT, Heuristic> search(heuristic, options.pathmax);
+    return search.run(initial_board, type, num_solutions_to_find, num_threads, time_limit_seconds);
+}
+
+#ifndef NDEBUG
+// 调试构建下统计并发哈希表的桶分布，用于确认哈希函数的均匀性：
+// 对均匀哈希，非空桶比例的期望为 1 - exp(-负载因子)
+template <typename Map>
+static void log_hash_distribution(const Map& map, const char* name) {
+    size_t bucket_count = map.unsafe_bucket_count();
+    if (map.empty() || bucket_count == 0) {
+        return;
+    }
+    std::vector<size_t> bucket_sizes(bucket_count, 0);
+    for (const auto& entry : map) {
+        ++bucket_sizes[map.unsafe_bucket(entry.first)];
+    }
+    size_t non_empty = 0;
+    size_t longest = 0;
+    for (size_t n : bucket_sizes) {
+        non_empty += (n > 0);
+        longest = std::max(longest, n);
+    }
+    double load = static_cast<double>(map.size()) / bucket_count;
+    spdlog::default_logger()->info("Hash distribution ({}): {} keys, {} buckets, {:.1f}% non-empty ({:.1f}% expected for uniform hashing), longest chain {}.",
+                                   name, map.size(), bucket_count, 100.0 * non_empty / bucket_count,
+                                   100.0 * (1.0 - std::exp(-load)), longest);
+}
+#endif
+
+template <typename BoardT, typename Heuristic>
+std::vector<Solution> AStarSearch<BoardT, Heuristic>::run(const BoardT& initial_board, SolveType type, int num_solutions_to_find, int num_threads, int time_limit_seconds) {
     // PuzzleSolver 将使用全局的 spdlog 默认日志器，无需在此处初始化或作为成员
     // if (!console_logger) {
     //     console_logger = spdlog::stdout_color_mt("console");
@@ -23,17 +234,21 @@ std::vector<Solution> PuzzleSolver::solve(const Board& initial_board, SolveType
 
 
     // 清空上次运行可能留下的数据并重新构造
-    open_set = tbb::concurrent_priority_queue<State, CompareStateForTBB>(); // 使用自定义比较器
-    g_costs = tbb::concurrent_unordered_map<Board, int>();
-    came_from = tbb::concurrent_unordered_map<Board, Board>(); // 清空 came_from map
+    open_set = tbb::concurrent_priority_queue<State<BoardT, Heuristic>, CompareStateForTBB>(); // 使用自定义比较器
+    g_costs = tbb::concurrent_unordered_map<BoardT, NodeRecord>();
+    came_from = tbb::concurrent_unordered_map<BoardT, BoardT>(); // 清空 came_from map
     found_solutions.clear();
     terminate_search.store(false); // 重置终止标志
     states_explored.store(0);      // 重置探索状态计数
+    states_reexpanded.store(0);
+    pathmax_raised.store(0);
     // 移除了 initial_board_storage 的赋值
 
     // 初始化起始状态
-    int initial_h = initial_board.get_manhattan_distance();
-    open_set.push(State(initial_board, 0, initial_h)); // State 不再存储路径
+    int initial_manhattan = initial_board.get_manhattan_distance();
+    typename Heuristic::NodeData initial_data;
+    int initial_h = heuristic.init(initial_board, initial_manhattan, initial_data);
+    open_set.push(State<BoardT, Heuristic>(initial_board, 0, initial_h, initial_manhattan, initial_data)); // State 不再存储路径
     g_costs.emplace(initial_board, 0); // 使用 emplace 插入
 
     // TBB task_group 用于管理并发任务
@@ -55,7 +270,13 @@ std::vector<Solution> PuzzleSolver::solve(const Board& initial_board, SolveType
     if (terminate_search.load()) {
         spdlog::default_logger()->warn("Search terminated early due to time limit or solution found.");
     }
-    spdlog::default_logger()->info("Search finished. Total states explored: {}", states_explored.load());
+    spdlog::default_logger()->info("Search finished. Total states explored: {} ({} re-expanded)", states_explored.load(), states_reexpanded.load());
+    if (pathmax) {
+        spdlog::default_logger()->info("BPMX raised {} child heuristic values.", pathmax_raised.load());
+    }
+#ifndef NDEBUG
+    log_hash_distribution(g_costs, "g_costs");
+#endif
 
     // 从 set 中提取前 num_solutions_to_find 个解决方案
     std::vector<Solution> result_solutions;
@@ -69,9 +290,18 @@ std::vector<Solution> PuzzleSolver::solve(const Board& initial_board, SolveType
     return result_solutions;
 }
 
-void PuzzleSolver::worker_thread_func(SolveType type, int num_solutions_to_find, const Board& initial_board_for_reconstruction,
+template <typename BoardT, typename Heuristic>
+void AStarSearch<BoardT, Heuristic>::worker_thread_func(SolveType type, int num_solutions_to_find, const BoardT& initial_board_for_reconstruction,
                                      std::chrono::high_resolution_clock::time_point start_time, int time_limit_seconds) {
-    State current_state; // 用于从 open_set 中取出的状态
+    State<BoardT, Heuristic> current_state; // 用于从 open_set 中取出的状态
+    // 一次展开中需要计算启发值的邻居，跨循环复用；全部算出启发值（BPMX 需要）后再入队。
+    // 不做 BPMX 时只记录需要入队的邻居，做 BPMX 时记录全部邻居，child_pushed 标记其中需要入队的
+    std::vector<BoardT> child_boards;
+    std::vector<typename Heuristic::NodeData> child_data;
+    std::vector<ChildSlot<BoardT, typename Heuristic::NodeData>> child_slots;
+    std::vector<uint8_t> child_directions;
+    std::vector<NodeRecord*> child_records; // 并发哈希表的元素地址在插入后不变
+    std::vector<uint8_t> child_pushed;
     auto last_log_time = std::chrono::high_resolution_clock::now();
 
     while (!terminate_search.load() && open_set.try_pop(current_state)) {
@@ -116,7 +346,7 @@ void PuzzleSolver::worker_thread_func(SolveType type, int num_solutions_to_find,
 
         // 如果当前状态的 g_cost 已经比已知达到该状态的最小 g_cost 大，说明找到了更优路径，跳过
         auto g_cost_it = g_costs.find(current_state.board);
-        if (g_cost_it != g_costs.end() && current_state.g_cost > g_cost_it->second) {
+        if (g_cost_it != g_costs.end() && current_state.g_cost > g_cost_it->second.g_cost) {
             continue;
         }
 
@@ -124,7 +354,7 @@ void PuzzleSolver::worker_thread_func(SolveType type, int num_solutions_to_find,
         if (current_state.board.is_goal()) {
             std::lock_guard<std::mutex> lock(solutions_mutex); // 保护 found_solutions
             // 重建路径，将初始棋盘传递给 reconstruct_path
-            std::vector<Board> path = reconstruct_path(current_state.board, initial_board_for_reconstruction);
+            std::vector<std::vector<int>> path = reconstruct_path(current_state.board, initial_board_for_reconstruction);
             found_solutions.insert({current_state.g_cost, path});
             
             // 使用 ostringstream 转换 thread ID 为字符串，并获取 C 字符串
@@ -143,56 +373,125 @@ void PuzzleSolver::worker_thread_func(SolveType type, int num_solutions_to_find,
             continue; // 继续下一个循环，尝试弹出下一个状态
         }
 
-        // 根据求解类型获取邻居状态
-        std::vector<Board> neighbors;
-        if (type == SolveType::AdjacentSwap) {
-            neighbors = current_state.board.get_neighbors_adjacent_swap();
-        } else { // SolveType::BlockShift
-            neighbors = current_state.board.get_neighbors_block_shift();
+        if (g_cost_it != g_costs.end()) {
+            // 启发函数不一致时，已展开的状态可能以更小的 g 值再次出队
+            if (g_cost_it->second.expanded.exchange(true)) {
+                states_reexpanded++;
+            }
         }
 
-        // 遍历所有邻居
-        for (const Board& neighbor_board : neighbors) {
-            int new_g_cost = current_state.g_cost + 1; // 每次移动代价为 1
+        const int new_g_cost = current_state.g_cost + 1; // 每次移动代价为 1
+        child_boards.clear();
+        child_data.clear();
+        child_slots.clear();
+        child_directions.clear();
+        child_records.clear();
+        child_pushed.clear();
+
+        // 处理一个邻居：邻居的曼哈顿距离已由父状态的曼哈顿距离增量算出，direction 为这一步的空格移动方向；
+        // 不做 BPMX 时启发值只在邻居需要入队时才计算
+        auto relax = [&](const BoardT& neighbor_board, int neighbor_manhattan, int direction) {
 
             // 尝试插入或更新 g_cost 和 came_from 映射
             // 注意：tbb::concurrent_unordered_map 的 emplace/insert/update 机制
             // 这里我们希望在找到更短路径时，更新 came_from 并重新加入 open_set
-            
+
             // 尝试插入新的 g_cost
             auto [it_g, inserted_g] = g_costs.emplace(neighbor_board, new_g_cost);
 
+            // 先记下邻居，枚举结束后统一计算启发值再入队
+            auto record_neighbor = [&](bool pushed) {
+                child_boards.push_back(neighbor_board);
+                child_directions.push_back(static_cast<uint8_t>(direction));
+                child_slots.push_back({nullptr, neighbor_manhattan, nullptr, 0});
+                child_records.push_back(&it_g->second);
+                child_pushed.push_back(pushed);
+            };
+            auto push_neighbor = [&] { record_neighbor(true); };
+
             if (inserted_g) {
                 // 如果成功插入，说明是第一次访问这个邻居
-                int neighbor_h = neighbor_board.get_manhattan_distance();
-                open_set.push(State(neighbor_board, new_g_cost, neighbor_h));
+                push_neighbor();
                 came_from.emplace(neighbor_board, current_state.board); // 记录父子关系
             } else {
                 // 如果 g_cost 已经存在，检查是否找到了更短的路径
-                if (new_g_cost < it_g->second) {
+                if (new_g_cost < it_g->second.g_cost) {
                     // 更新 g_cost
-                    it_g->second = new_g_cost; // 更新已存在的 g_cost
-                    int neighbor_h = neighbor_board.get_manhattan_distance();
-                    open_set.push(State(neighbor_board, new_g_cost, neighbor_h)); // 将更新后的状态重新推入优先队列
+                    it_g->second.g_cost = new_g_cost; // 更新已存在的 g_cost
+                    push_neighbor(); // 将更新后的状态重新推入优先队列
 
                     // 更新 came_from。由于 neighbor_board 在此分支中必然已存在于 came_from (因为它存在于 g_costs)，
                     // 可以安全地使用 operator[] 来更新其关联的值。
                     came_from[neighbor_board] = current_state.board;
+                } else if (pathmax) {
+                    record_neighbor(false); // 不入队，但它的启发值仍可以抬高父节点
                 }
             }
+        };
+
+        // 根据求解类型原地枚举邻居状态，不分配临时容器；
+        // 按上一步方向查剪枝表，撤销上一步的移动（批量位移下为同一轴上的移动）根本不生成，省去一次哈希表查找
+        const unsigned directions = allowed_directions(type, current_state.last_move);
+        if (type == SolveType::AdjacentSwap) {
+            current_state.board.for_each_adjacent_swap(current_state.manhattan, directions, relax);
+        } else { // SolveType::BlockShift
+            current_state.board.for_each_block_shift(current_state.manhattan, directions, relax);
+        }
+
+        // 邻居的启发值按 kMaxChildBatch 分批计算（见 evaluate_children）；vector 不再增长后才取元素地址
+        const size_t child_count = child_boards.size();
+        child_data.resize(child_count);
+        for (size_t i = 0; i < child_count; ++i) {
+            child_slots[i].board = &child_boards[i];
+            child_slots[i].data = &child_data[i];
+        }
+        for (size_t first = 0; first < child_count; first += kMaxChildBatch) {
+            evaluate_children(heuristic, current_state.board, current_state.heuristic_data, child_slots.data() + first,
+                              static_cast<int>(std::min<size_t>(kMaxChildBatch, child_count - first)), std::numeric_limits<int>::max());
+        }
+        if (pathmax) {
+            // 单位代价的无向图中相邻状态的真实距离至多差 1：先由子节点抬高父节点的 h，再由父节点抬高子节点的 h。
+            // 各状态先前抬高过的值记在 g_costs 中，一并参与
+            NodeRecord* current_record = g_cost_it != g_costs.end() ? &g_cost_it->second : nullptr;
+            int parent_h = current_state.h_cost;
+            if (current_record != nullptr) {
+                parent_h = std::max(parent_h, current_record->h_cost.load(std::memory_order_relaxed));
+            }
+            for (size_t i = 0; i < child_count; ++i) {
+                child_slots[i].h = std::max(child_slots[i].h, child_records[i]->h_cost.load(std::memory_order_relaxed));
+                parent_h = std::max(parent_h, child_slots[i].h - 1);
+            }
+            if (current_record != nullptr) {
+                current_record->raise_h(parent_h);
+            }
+            for (size_t i = 0; i < child_count; ++i) {
+                if (child_slots[i].h < parent_h - 1) {
+                    child_slots[i].h = parent_h - 1;
+                    pathmax_raised++;
+                }
+                child_records[i]->raise_h(child_slots[i].h);
+            }
+        }
+        for (size_t i = 0; i < child_count; ++i) {
+            if (!child_pushed[i]) {
+                continue;
+            }
+            open_set.push(State<BoardT, Heuristic>(child_boards[i], new_g_cost, child_slots[i].h, child_slots[i].manhattan, child_data[i],
+                                                   child_directions[i]));
         }
     }
 }
 
 // 辅助函数：从 came_from 映射重建路径
 // 现在接收 initial_board 作为参数
-std::vector<Board> PuzzleSolver::reconstruct_path(const Board& goal_board, const Board& initial_board) {
-    std::vector<Board> path;
-    Board current = goal_board;
+template <typename BoardT, typename Heuristic>
+std::vector<std::vector<int>> AStarSearch<BoardT, Heuristic>::reconstruct_path(const BoardT& goal_board, const BoardT& initial_board) {
+    std::vector<std::vector<int>> path;
+    BoardT current = goal_board;
 
     // 回溯直到找到初始棋盘
     while (!(current == initial_board)) { // 使用传入的 initial_board 作为终止条件
-        path.push_back(current);
+        path.push_back(current.to_tiles());
         // 在 came_from 中查找当前棋盘的父棋盘
         auto it = came_from.find(current);
         if (it != came_from.end()) {
@@ -203,8 +502,262 @@ std::vector<Board> PuzzleSolver::reconstruct_path(const Board& goal_board, const
             break; // 避免无限循环
         }
     }
-    path.push_back(initial_board); // 添加初始棋盘
+    path.push_back(initial_board.to_tiles()); // 添加初始棋盘
 
     std::reverse(path.begin(), path.end()); // 路径是逆序的，需要反转
     return path;
 }
+
+template <typename BoardT, typename Heuristic>
+std::vector<Solution> IDAStarSearch<BoardT, Heuristic>::run(const BoardT& initial_board, SolveType type, int num_solutions_to_find, int num_threads, int time_limit_seconds) {
+    spdlog::default_logger()->info("Starting IDA* with {} threads.", num_threads);
+    if (time_limit_seconds > 0) {
+        spdlog::default_logger()->info("Time limit: {} seconds.", time_limit_seconds);
+    } else {
+        spdlog::default_logger()->info("No time limit set.");
+    }
+    spdlog::default_logger()->info("Initial Board:\n{}", initial_board.to_string());
+
+    automaton = MoveAutomaton::get(initial_board.rows(), initial_board.cols(), type);
+    solve_type = type;
+    solutions_wanted = num_solutions_to_find;
+    time_limit = time_limit_seconds;
+    start_time = std::chrono::high_resolution_clock::now();
+    found_solutions.clear();
+    terminate_search.store(num_solutions_to_find <= 0);
+    states_explored.store(0);
+    pathmax_cutoffs.store(0);
+
+    // 从根节点逐层展开，直到子树数量足够分给所有线程（最多展开 4 层）
+    const int initial_manhattan = initial_board.get_manhattan_distance();
+    typename Heuristic::NodeData initial_data;
+    const int initial_h = heuristic.init(initial_board, initial_manhattan, initial_data);
+    std::vector<Subtree> subtrees{{initial_board, 0, initial_h, initial_manhattan, initial_data, initial_h, MoveAutomaton::kStart, {}}};
+    const size_t wanted_subtrees = static_cast<size_t>(std::max(num_threads, 1)) * 8;
+    for (int depth = 0; depth < 4 && subtrees.size() < wanted_subtrees; ++depth) {
+        std::vector<Subtree> next_subtrees;
+        for (const Subtree& subtree : subtrees) {
+            if (subtree.board.is_goal()) {
+                next_subtrees.push_back(subtree); // 目标状态是叶子
+                continue;
+            }
+            std::vector<BoardT> path = subtree.path;
+            path.push_back(subtree.board);
+            expand(subtree.board, subtree.manhattan, subtree.heuristic_data, subtree.automaton_state, std::numeric_limits<int>::max(),
+                   [&](const BoardT& child, int child_manhattan, const typename Heuristic::NodeData& child_data, int child_h, int32_t child_state) {
+                int child_g = subtree.g_cost + 1;
+                if (pathmax) {
+                    child_h = std::max(child_h, subtree.h_cost - 1);
+                }
+                next_subtrees.push_back({child, child_g, child_h, child_manhattan, child_data, std::max(subtree.max_f_cost, child_g + child_h), child_state, path});
+            });
+        }
+        subtrees.swap(next_subtrees);
+    }
+
+    tbb::task_arena arena(std::max(num_threads, 1));
+    int bound = initial_h;
+    while (!terminate_search.load()) {
+        std::mutex bound_mutex;
+        int next_bound = std::numeric_limits<int>::max();
+        arena.execute([&] {
+            tbb::parallel_for(size_t(0), subtrees.size(), [&](size_t i) {
+                const Subtree& subtree = subtrees[i];
+                SearchContext context;
+                context.next_bound = std::numeric_limits<int>::max();
+                if (subtree.max_f_cost > bound) {
+                    context.next_bound = subtree.max_f_cost; // 路径上已有节点超过阈值，整棵子树本轮不可达
+                } else {
+                    context.path = subtree.path;
+                    search(subtree.board, subtree.g_cost, subtree.manhattan, subtree.heuristic_data, subtree.h_cost, subtree.automaton_state, bound, context);
+                }
+                states_explored += context.nodes;
+                pathmax_cutoffs += context.pathmax_cutoffs;
+                std::lock_guard<std::mutex> lock(bound_mutex);
+                next_bound = std::min(next_bound, context.next_bound);
+            });
+        });
+        spdlog::default_logger()->info("IDA* iteration with bound {} finished. Total states explored: {}", bound, states_explored.load());
+
+        if (found_solutions.size() >= static_cast<size_t>(num_solutions_to_find)) {
+            break;
+        }
+        if (next_bound == std::numeric_limits<int>::max()) {
+            break; // 所有路径都已穷尽
+        }
+        bound = next_bound;
+    }
+
+    if (found_solutions.size() < static_cast<size_t>(std::max(num_solutions_to_find, 0)) && terminate_search.load()) {
+        spdlog::default_logger()->warn("Search terminated early due to time limit.");
+    }
+    spdlog::default_logger()->info("Search finished. Total states explored: {}", states_explored.load());
+    if (pathmax) {
+        spdlog::default_logger()->info("BPMX cut off {} nodes whose raised f exceeded the bound.", pathmax_cutoffs.load());
+    }
+
+    std::vector<Solution> result_solutions;
+    for (const auto& sol : found_solutions) {
+        if (static_cast<int>(result_solutions.size()) >= num_solutions_to_find) break;
+        result_solutions.push_back(sol);
+    }
+    return result_solutions;
+}
+
+template <typename BoardT, typename Heuristic>
+template <typename Visitor>
+void IDAStarSearch<BoardT, Heuristic>::for_each_child(const BoardT& board, int manhattan, int32_t automaton_state, Visitor&& visit) const {
+    // 由空格移过的格子数得到本次移动的长度，再查自动机转移
+    auto filtered = [&](const BoardT& child, int child_manhattan, int direction) {
+        int distance = std::abs(static_cast<int>(child.blank) - static_cast<int>(board.blank));
+        int length = direction < 2 ? distance / board.cols() : distance;
+        int32_t child_state = automaton->next(automaton_state, automaton->symbol(direction, length));
+        if (child_state != MoveAutomaton::kPruned) {
+            visit(child, child_manhattan, child_state);
+        }
+    };
+    const unsigned directions = automaton->directions(automaton_state);
+    if (solve_type == SolveType::AdjacentSwap) {
+        board.for_each_adjacent_swap(manhattan, directions, filtered);
+    } else { // SolveType::BlockShift
+        board.for_each_block_shift(manhattan, directions, filtered);
+    }
+}
+
+template <typename BoardT, typename Heuristic>
+template <typename Visitor>
+void IDAStarSearch<BoardT, Heuristic>::expand(const BoardT& board, int manhattan, const typename Heuristic::NodeData& heuristic_data, int32_t automaton_state,
+                                              int limit, Visitor&& visit) const {
+    for_each_child(board, manhattan, automaton_state, [&](const BoardT& child, int child_manhattan, int32_t child_state) {
+        typename Heuristic::NodeData child_data;
+        int child_h = evaluate_child(heuristic, board, heuristic_data, child, child_manhattan, child_data, limit);
+        visit(child, child_manhattan, child_data, child_h, child_state);
+    });
+}
+
+template <typename BoardT, typename Heuristic>
+template <typename Visitor>
+void IDAStarSearch<BoardT, Heuristic>::expand_batched(const BoardT& board, int manhattan, const typename Heuristic::NodeData& heuristic_data,
+                                                      int32_t automaton_state, int limit, ChildBatch& batch, Visitor&& visit) const {
+    int count = 0;
+    auto flush = [&] {
+        evaluate_children(heuristic, board, heuristic_data, batch.slots.data(), count, limit);
+        for (int i = 0; i < count; ++i) {
+            visit(batch.boards[i], batch.slots[i].manhattan, batch.data[i], batch.slots[i].h, batch.automaton_states[i]);
+        }
+        count = 0;
+    };
+    for_each_child(board, manhattan, automaton_state, [&](const BoardT& child, int child_manhattan, int32_t child_state) {
+        batch.boards[count] = child;
+        batch.automaton_states[count] = child_state;
+        batch.slots[count] = {&batch.boards[count], child_manhattan, &batch.data[count], 0};
+        if (++count == kMaxChildBatch) {
+            flush();
+        }
+    });
+    if (count > 0) {
+        flush();
+    }
+}
+
+template <typename BoardT, typename Heuristic>
+void IDAStarSearch<BoardT, Heuristic>::expand_all(const BoardT& board, int manhattan, const typename Heuristic::NodeData& heuristic_data,
+                                                  int32_t automaton_state, int limit, ChildList& list) const {
+    list.boards.clear();
+    list.slots.clear();
+    list.automaton_states.clear();
+    for_each_child(board, manhattan, automaton_state, [&](const BoardT& child, int child_manhattan, int32_t child_state) {
+        list.boards.push_back(child);
+        list.automaton_states.push_back(child_state);
+        list.slots.push_back({nullptr, child_manhattan, nullptr, 0});
+    });
+    // vector 不再增长后才取元素地址
+    const size_t count = list.boards.size();
+    list.data.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        list.slots[i].board = &list.boards[i];
+        list.slots[i].data = &list.data[i];
+    }
+    for (size_t first = 0; first < count; first += kMaxChildBatch) {
+        evaluate_children(heuristic, board, heuristic_data, list.slots.data() + first, static_cast<int>(std::min<size_t>(kMaxChildBatch, count - first)),
+                          limit);
+    }
+}
+
+template <typename BoardT, typename Heuristic>
+int IDAStarSearch<BoardT, Heuristic>::search(const BoardT& board, int g_cost, int manhattan, const typename Heuristic::NodeData& heuristic_data, int h_cost,
+                                             int32_t automaton_state, int bound, SearchContext& context) {
+    const int f_cost = g_cost + h_cost;
+    if (f_cost > bound) {
+        context.next_bound = std::min(context.next_bound, f_cost);
+        return h_cost;
+    }
+    if (terminate_search.load(std::memory_order_relaxed)) {
+        return h_cost;
+    }
+    // 每 65536 个节点检查一次是否超时
+    if ((++context.nodes & 0xFFFF) == 0 && time_limit > 0 &&
+        std::chrono::duration_cast<std::chrono::seconds>(std::chrono::high_resolution_clock::now() - start_time).count() >= time_limit) {
+        spdlog::default_logger()->warn("IDA* reached time limit of {} seconds. Terminating search.", time_limit);
+        terminate_search.store(true);
+        return h_cost;
+    }
+
+    if (board.is_goal()) {
+        std::vector<std::vector<int>> path;
+        path.reserve(context.path.size() + 1);
+        for (const BoardT& step : context.path) {
+            path.push_back(step.to_tiles());
+        }
+        path.push_back(board.to_tiles());
+
+        std::lock_guard<std::mutex> lock(solutions_mutex);
+        found_solutions.insert({g_cost, std::move(path)});
+        spdlog::default_logger()->info("IDA* found solution with cost: {}. Total solutions found: {}", g_cost, found_solutions.size());
+        if (found_solutions.size() >= static_cast<size_t>(solutions_wanted)) {
+            terminate_search.store(true);
+        }
+        return 0;
+    }
+
+    const size_t depth = context.path.size();
+    if (pathmax) {
+        // 单位代价的无向图中相邻状态的真实距离至多差 1，子节点的 h 减一仍是父节点的下界，反之亦然
+        if (context.child_lists.size() <= depth) {
+            context.child_lists.resize(depth + 1);
+        }
+        ChildList& list = context.child_lists[depth];
+        expand_all(board, manhattan, heuristic_data, automaton_state, bound - g_cost - 1, list);
+        int h = h_cost;
+        for (const auto& slot : list.slots) {
+            h = std::max(h, slot.h - 1);
+        }
+        context.path.push_back(board);
+        for (size_t i = 0; i < list.boards.size() && g_cost + h <= bound; ++i) {
+            const int child_h = std::max(list.slots[i].h, h - 1);
+            const int raised = search(list.boards[i], g_cost + 1, list.slots[i].manhattan, list.data[i], child_h, list.automaton_states[i], bound, context);
+            h = std::max(h, raised - 1); // 子树返回时把抬高的 h 传回
+        }
+        context.path.pop_back();
+        if (g_cost + h > bound) {
+            ++context.pathmax_cutoffs;
+            context.next_bound = std::min(context.next_bound, g_cost + h);
+        }
+        return h;
+    }
+
+    auto visit = [&](const BoardT& child, int child_manhattan, const typename Heuristic::NodeData& child_data, int child_h, int32_t child_state) {
+        search(child, g_cost + 1, child_manhattan, child_data, child_h, child_state, bound, context);
+    };
+    context.path.push_back(board);
+    if (batch_children) {
+        if (context.batches.size() <= depth) {
+            context.batches.resize(depth + 1);
+        }
+        expand_batched(board, manhattan, heuristic_data, automaton_state, bound - g_cost - 1, context.batches[depth], visit);
+    } else {
+        expand(board, manhattan, heuristic_data, automaton_state, bound - g_cost - 1, visit);
+    }
+    context.path.pop_back();
+    return h_cost;
+}
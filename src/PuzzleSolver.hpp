@@ -3,12 +3,21 @@
 #define PUZZLE_SOLVER_HPP
 
 #include "Board.hpp"
+#include "HeuristicPipeline.hpp"
+#include "Heuristics.hpp"
+#include "MoveAutomaton.hpp"
+#include "MovePruning.hpp"
+#include "SolveType.hpp"
+#include <array>
+#include <deque>
 #include <vector>
 #include <string>
 #include <set>        // For std::set to store unique sorted solutions
 #include <atomic>     // For std::atomic_bool for termination flag
 #include <mutex>      // For std::mutex for protecting shared data
 #include <algorithm>  // For std::min, std::max
+#include <chrono>     // For std::chrono::high_resolution_clock
+#include <memory>     // For std::shared_ptr
 
 // TBB 并发容器
 #include <tbb/concurrent_priority_queue.h>
@@ -18,32 +27,33 @@
 #include <spdlog/spdlog.h>
 #include <spdlog/sinks/stdout_color_sinks.h> // For console output
 
-// 定义求解类型
-enum class SolveType {
-    AdjacentSwap, // 相邻交换计分
-    BlockShift    // 批量位移计分
-};
-
 // 定义 A* 算法中的状态节点
+// BoardT 为打包棋盘表示（Board<N, M> 或 Board16 / Board25 / Board64），由 PuzzleSolver::solve 按棋盘尺寸选择
+// Heuristic 为启发函数策略（见 Heuristics.hpp），由 SolverOptions::heuristic 选择
+template <typename BoardT, typename Heuristic = ManhattanHeuristic>
 struct State {
-    Board board;          // 当前棋盘状态
+    BoardT board;         // 当前棋盘状态
     int g_cost;           // 从起始状态到当前状态的实际代价（已走步数）
-    int h_cost;           // 从当前状态到目标状态的启发式估计代价（曼哈顿距离）
+    int h_cost;           // 从当前状态到目标状态的启发式估计代价
     int f_cost;           // g_cost + h_cost (总估计代价)
+    int manhattan;        // 曼哈顿距离，邻居枚举函数据此增量计算子状态的曼哈顿距离
+    typename Heuristic::NodeData heuristic_data; // 启发函数的增量数据
+    uint8_t last_move;    // 到达该状态的空格移动方向，根节点为 kNoMove；扩展时据此查剪枝表
 
     // 默认构造函数，TBB 并发容器可能需要
-    State() : board(0, 0, {}), g_cost(0), h_cost(0), f_cost(0) {}
+    State() : board(), g_cost(0), h_cost(0), f_cost(0), manhattan(0), heuristic_data(), last_move(kNoMove) {}
 
     // 构造函数
-    State(Board b, int g, int h) :
-        board(b), g_cost(g), h_cost(h), f_cost(g + h) {}
+    State(const BoardT& b, int g, int h, int md, const typename Heuristic::NodeData& data, uint8_t last = kNoMove) :
+        board(b), g_cost(g), h_cost(h), f_cost(g + h), manhattan(md), heuristic_data(data), last_move(last) {}
 };
 
 // 自定义比较器，用于 tbb::concurrent_priority_queue，使其作为最小堆工作。
 // 对于 max-heap， operator() 返回 true 表示第一个参数“优先级更高”（即应该在堆的顶部）。
 // 在这里，f_cost 越小优先级越高，f_cost 相同则 g_cost 越小优先级越高。
 struct CompareStateForTBB {
-    bool operator()(const State& a, const State& b) const {
+    template <typename StateT>
+    bool operator()(const StateT& a, const StateT& b) const {
         if (a.f_cost != b.f_cost) {
             return a.f_cost > b.f_cost; // a 的 f_cost 更小，表示 a 优先级更高 (TBB is max heap, so use > for min-heap behavior)
         }
@@ -54,39 +64,51 @@ struct CompareStateForTBB {
 // 定义找到的解决方案结构体
 struct Solution {
     int cost;             // 解决方案的总代价
-    std::vector<Board> path; // 构成解决方案的棋盘状态序列
+    std::vector<std::vector<int>> path; // 构成解决方案的棋盘状态序列（按行优先展开的数字）
 
     // 用于 std::set 的比较操作符，确保解决方案按代价排序且唯一
     bool operator<(const Solution& other) const {
         if (cost != other.cost) {
             return cost < other.cost; // 优先按代价排序
         }
-        // 如果代价相同，则按路径的字典序（或 Board 的字典序）排序，以确保唯一性
+        // 如果代价相同，则按路径的字典序排序，以确保唯一性
         // 对于相同的代价，如果路径不同，set 也能区分它们
         return path < other.path;
     }
 };
 
-// 数字华容道求解器类
-class PuzzleSolver {
+// 针对某一种棋盘表示与启发函数的 A* 搜索。
+// 启发函数不一致时（压缩表、对偶查表等）已扩展的状态可能以更小的 g 值再次出队并重新展开，搜索结束时输出重新展开的次数；
+// pathmax 为 true 时在父子之间做一层 BPMX：父节点的 h 不小于子节点 h 的最大值减一，子节点的 h 不小于父节点的 h 减一；
+// 父节点由全部生成的邻居抬高（包括因 g 值不更优而不入队的邻居），抬高后的值记在 g_costs 中，状态重新入队时不会丢失
+template <typename BoardT, typename Heuristic = ManhattanHeuristic>
+class AStarSearch {
 public:
-    // 核心求解方法
-    // initial_board: 初始棋盘状态
-    // type: 求解类型 (相邻交换或批量位移)
-    // num_solutions_to_find: 希望找到的最优解数量
-    // num_threads: 线程数量
-    // time_limit_seconds: 求解的时间限制（秒），0 表示无限制
-    std::vector<Solution> solve(const Board& initial_board, SolveType type, int num_solutions_to_find, int num_threads, int time_limit_seconds);
+    explicit AStarSearch(Heuristic heuristic = Heuristic(), bool pathmax = false) : heuristic(heuristic), pathmax(pathmax) {}
 
-private:
-    // 日志器已移除，PuzzleSolver 将直接使用 spdlog::default_logger()
-    // std::shared_ptr<spdlog::logger> console_logger;
+    std::vector<Solution> run(const BoardT& initial_board, SolveType type, int num_solutions_to_find, int num_threads, int time_limit_seconds);
 
+private:
     // A* 算法所需的数据结构，现为并发版本
     // 使用自定义比较器 CompareStateForTBB
-    tbb::concurrent_priority_queue<State, CompareStateForTBB> open_set;
-    tbb::concurrent_unordered_map<Board, int> g_costs; // 存储到达某个棋盘状态的最小 g_cost
-    tbb::concurrent_unordered_map<Board, Board> came_from; // 用于路径重建：came_from[child_board] = parent_board
+    tbb::concurrent_priority_queue<State<BoardT, Heuristic>, CompareStateForTBB> open_set;
+    // g_costs 中每个状态的记录。expanded 由多个工作线程读写，必须是原子量；原子量不可移动，记录用 emplace(board, g_cost) 原地构造
+    struct NodeRecord {
+        int g_cost;                         // 到达该状态的最小 g_cost
+        std::atomic<bool> expanded{false}; // 是否已经展开过，再次展开即为重新展开
+        std::atomic<int> h_cost{0};        // BPMX 抬高过的启发值（只增不减），状态以更小的 g 重新入队时沿用
+
+        explicit NodeRecord(int g) : g_cost(g) {}
+
+        void raise_h(int h) {
+            int current = h_cost.load(std::memory_order_relaxed);
+            while (current < h && !h_cost.compare_exchange_weak(current, h, std::memory_order_relaxed)) {
+            }
+        }
+    };
+
+    tbb::concurrent_unordered_map<BoardT, NodeRecord> g_costs; // 存储到达某个棋盘状态的最小 g_cost
+    tbb::concurrent_unordered_map<BoardT, BoardT> came_from; // 用于路径重建：came_from[child_board] = parent_board
 
     // 存储找到的解决方案
     std::set<Solution> found_solutions;
@@ -97,15 +119,177 @@ private:
 
     // 记录探索过的状态数量
     std::atomic<long long> states_explored;
+    std::atomic<long long> states_reexpanded; // 其中重新展开的状态数
+    std::atomic<long long> pathmax_raised;    // BPMX 抬高的子节点启发值个数
+
+    Heuristic heuristic;
+    bool pathmax; // 见 SolverOptions::pathmax
 
     // 用于并行处理 A* 搜索的单个工作线程函数
-    // initial_board 现在通过 lambda 捕获并传递给 reconstruct_path
-    void worker_thread_func(SolveType type, int num_solutions_to_find, const Board& initial_board_for_reconstruction,
+    void worker_thread_func(SolveType type, int num_solutions_to_find, const BoardT& initial_board_for_reconstruction,
                             std::chrono::high_resolution_clock::time_point start_time, int time_limit_seconds);
 
     // 辅助函数：从 came_from 映射重建路径
-    // 现在接收 initial_board 作为参数
-    std::vector<Board> reconstruct_path(const Board& current_board, const Board& initial_board);
+    std::vector<std::vector<int>> reconstruct_path(const BoardT& current_board, const BoardT& initial_board);
+};
+
+// 针对某一种棋盘表示的迭代加深 A* (IDA*) 搜索。
+// 内存只与解的深度成正比，不维护 g_costs 表；重复路径由 MoveAutomaton 在生成子节点时剪去。
+// 根节点先展开几层得到足够多的子树，每轮迭代把子树分给 num_threads 个线程做深度优先搜索。
+// pathmax 为 true 时做 BPMX：先算出全部子节点的启发值，把 max(h(子) - 1) 传回父节点、h(父) - 1 传给子节点，
+// 子树返回时再把抬高的 h 传回父节点；父节点的 f 因此超过阈值时剩下的兄弟子树不再搜索。
+template <typename BoardT, typename Heuristic = ManhattanHeuristic>
+class IDAStarSearch {
+public:
+    explicit IDAStarSearch(Heuristic heuristic = Heuristic(), bool batch_children = false, bool pathmax = false)
+        : heuristic(heuristic), batch_children(batch_children), pathmax(pathmax) {}
+
+    std::vector<Solution> run(const BoardT& initial_board, SolveType type, int num_solutions_to_find, int num_threads, int time_limit_seconds);
+
+private:
+    // 根节点展开后分给线程的一棵子树
+    struct Subtree {
+        BoardT board;
+        int g_cost;
+        int h_cost;
+        int manhattan;
+        typename Heuristic::NodeData heuristic_data;
+        int max_f_cost;                // 从根到该节点路径上的最大 f 值，超过本轮阈值时整棵子树跳过
+        int32_t automaton_state;
+        std::vector<BoardT> path;      // 从根到父节点的棋盘序列
+    };
+
+    // 同一父节点的一批子节点，批量计算启发值后再依次访问
+    struct ChildBatch {
+        std::array<BoardT, kMaxChildBatch> boards;
+        std::array<typename Heuristic::NodeData, kMaxChildBatch> data;
+        std::array<ChildSlot<BoardT, typename Heuristic::NodeData>, kMaxChildBatch> slots;
+        std::array<int32_t, kMaxChildBatch> automaton_states;
+    };
+
+    // 一个节点的全部子节点，BPMX 在递归之前需要它们的启发值；子节点个数没有编译期上限，用 vector 按深度复用
+    struct ChildList {
+        std::vector<BoardT> boards;
+        std::vector<typename Heuristic::NodeData> data;
+        std::vector<ChildSlot<BoardT, typename Heuristic::NodeData>> slots;
+        std::vector<int32_t> automaton_states;
+    };
+
+    // 每个线程的深度优先搜索上下文
+    struct SearchContext {
+        std::vector<BoardT> path;      // 从根到当前节点父节点的棋盘序列
+        std::deque<ChildBatch> batches; // 按深度复用的子节点批，不占递归栈；deque 增长时已有元素的引用不失效
+        std::deque<ChildList> child_lists; // 同上，BPMX 使用
+        long long nodes = 0;
+        long long pathmax_cutoffs = 0; // BPMX 抬高父节点的 h 后剪去的节点数
+        int next_bound;                // 本轮被剪枝节点的最小 f 值，即下一轮阈值的候选
+    };
+
+    Heuristic heuristic;
+    bool batch_children;           // 见 SolverOptions::batch_children
+    bool pathmax;                  // 见 SolverOptions::pathmax
+    std::shared_ptr<const MoveAutomaton> automaton;
+    SolveType solve_type = SolveType::AdjacentSwap;
+    int solutions_wanted = 1;
+    int time_limit = 0;
+    std::chrono::high_resolution_clock::time_point start_time;
+
+    std::set<Solution> found_solutions;
+    std::mutex solutions_mutex; // 保护 found_solutions
+    std::atomic<bool> terminate_search;
+    std::atomic<long long> states_explored;
+    std::atomic<long long> pathmax_cutoffs;
+
+    // 枚举未被自动机剪枝的子节点：visit(const BoardT& child, int child_manhattan, int32_t child_automaton_state)
+    template <typename Visitor>
+    void for_each_child(const BoardT& board, int manhattan, int32_t automaton_state, Visitor&& visit) const;
+
+    // 枚举未被自动机剪枝的子节点并计算其启发值：
+    // visit(const BoardT& child, int child_manhattan, const NodeData& child_data, int child_h, int32_t child_automaton_state)
+    // 子节点的 h 超过 limit 时一定被剪枝，支持剪枝上限的启发函数可以只算到超过 limit 为止（见 Heuristics.hpp）
+    template <typename Visitor>
+    void expand(const BoardT& board, int manhattan, const typename Heuristic::NodeData& heuristic_data, int32_t automaton_state, int limit,
+                Visitor&& visit) const;
+
+    // 同 expand，但子节点在 batch 中攒满 kMaxChildBatch 个或枚举结束时一起计算启发值（见 evaluate_children），再按枚举顺序访问
+    template <typename Visitor>
+    void expand_batched(const BoardT& board, int manhattan, const typename Heuristic::NodeData& heuristic_data, int32_t automaton_state, int limit,
+                        ChildBatch& batch, Visitor&& visit) const;
+
+    // 把全部子节点及其启发值（按 kMaxChildBatch 分批计算）写入 list
+    void expand_all(const BoardT& board, int manhattan, const typename Heuristic::NodeData& heuristic_data, int32_t automaton_state, int limit,
+                    ChildList& list) const;
+
+    // 返回该节点经 BPMX 抬高后的 h（不做 BPMX 时即 h_cost），供父节点回传
+    int search(const BoardT& board, int g_cost, int manhattan, const typename Heuristic::NodeData& heuristic_data, int h_cost,
+                int32_t automaton_state, int bound, SearchContext& context);
+};
+
+// 搜索引擎
+enum class SearchEngine {
+    AStar,   // 并行 A*，用 g_costs 哈希表去重
+    IDAStar  // 迭代加深 A*，内存线性，用 MoveAutomaton 剪去重复路径
+};
+
+// 启发函数
+enum class HeuristicKind {
+    Manhattan,      // 曼哈顿距离
+    LinearConflict, // 曼哈顿距离 + 线性冲突，增量维护
+    WalkingDistance, // Walking Distance 查表，逐步查转移表更新
+    PatternDatabase, // 加性不相交模式数据库（批量位移计分下按批量位移构造、取最大值）
+    BlockCrossing    // 批量位移计分下的行列穿越下界；相邻交换计分下改用曼哈顿距离
+};
+
+// 模式数据库之前先计算的廉价组件（见 HeuristicPipeline.hpp）；批量位移计分下一律改用行列穿越下界
+enum class PatternPrefilter {
+    None,            // 只查模式数据库
+    Manhattan,
+    LinearConflict,
+    WalkingDistance
+};
+
+// 单次求解的可选项，默认值与原有行为一致
+struct SolverOptions {
+    bool use_distance_oracle = true;               // 有完全距离表的小棋盘直接查表；关闭后照常搜索，便于在 3x3、3x4 上运行和比较各搜索路径
+    SearchEngine engine = SearchEngine::AStar;
+    HeuristicKind heuristic = HeuristicKind::Manhattan;
+    bool walking_distance_linear_conflict = false; // WD 与曼哈顿距离 + 线性冲突取最大值
+    std::string pattern_partition;                 // 模式数据库的划分，空串为该形状的默认划分，见 resolve_partition
+    PatternStorage pattern_storage;                // 模式数据库的存储方式，默认不压缩
+    bool pattern_reflection = false;               // 另取沿主对角线反射后的查表值（仅方形棋盘）
+    bool pattern_dual = false;                     // 另取对偶局面的查表值
+    PatternPrefilter pattern_prefilter = PatternPrefilter::None; // 与模式数据库取最大值、IDA* 中先于查表计算的廉价组件
+    bool batch_children = false;                   // IDA* 中同一父节点的子节点一起计算启发值（A* 总是如此），模式数据库查表交错进行
+    bool pathmax = false;                          // 在父子节点之间双向传递启发值（BPMX），用于不一致的启发函数
+};
+
+// 数字华容道求解器类
+class PuzzleSolver {
+public:
+    // 核心求解方法
+    // N, M: 棋盘行数与列数
+    // initial_tiles: 按行优先排列的初始棋盘数字，0 代表空格
+    // type: 求解类型 (相邻交换或批量位移)
+    // num_solutions_to_find: 希望找到的最优解数量
+    // num_threads: 线程数量
+    // time_limit_seconds: 求解的时间限制（秒），0 表示无限制
+    // options: 搜索引擎、启发函数等可选项
+    // 搜索前先做预分析（见 PuzzleAnalysis）：非法或不可解的输入返回空结果，已还原的棋盘返回代价为 0 的解；
+    // 行列均不少于 2 且不超过 12 格的形状（2x2 ~ 3x4）在 oracle_builder 已构造完全距离表时沿表下降，不运行搜索
+    // （options.use_distance_oracle 为 false 时跳过，此时引擎与启发函数选项才对这些形状生效）；
+    // 2x2、3x3、4x4、5x5、3x4、4x3 使用编译期特化的 Board<N, M>；
+    // 其余形状按格子数选择最窄的打包表示：16 格以内用 Board16，25 格以内用 Board25，64 格以内用 Board64
+    std::vector<Solution> solve(int N, int M, const std::vector<int>& initial_tiles, SolveType type, int num_solutions_to_find, int num_threads, int time_limit_seconds,
+                                const SolverOptions& options = SolverOptions());
+
+private:
+    template <typename BoardT>
+    std::vector<Solution> run_search(int N, int M, const std::vector<int>& initial_tiles, SolveType type, int num_solutions_to_find, int num_threads, int time_limit_seconds,
+                                     const SolverOptions& options);
+
+    template <typename BoardT, typename Heuristic>
+    std::vector<Solution> run_engine(const BoardT& initial_board, SolveType type, int num_solutions_to_find, int num_threads, int time_limit_seconds,
+                                     const SolverOptions& options, const Heuristic& heuristic);
 };
 
 #endif // PUZZLE_SOLVER_HPP
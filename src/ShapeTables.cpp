@@ -0,0 +1,18 @@
+#include "ShapeTables.hpp"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+const ShapeTables& shape_tables(int rows, int cols) {
+    static std::mutex registry_mutex;
+    static std::map<std::pair<int, int>, std::unique_ptr<ShapeTables>> registry;
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    auto& slot = registry[{rows, cols}];
+    if (!slot) {
+        slot = std::make_unique<ShapeTables>(make_shape_tables(rows, cols));
+    }
+    return *slot;
+}
@@ -0,0 +1,76 @@
+#ifndef SHAPE_TABLES_HPP
+#define SHAPE_TABLES_HPP
+
+#include <array>
+#include <cstdint>
+
+// 按棋盘形状预先计算的查找表。
+// 编译期特化的形状 (FixedShape) 在编译期构造，运行期形状 (DynamicShape) 通过 shape_tables() 按需构造并缓存。
+struct ShapeTables {
+    static constexpr int kMaxCells = 64;
+    static constexpr int kDirections = 4; // 空格移动方向：0 上，1 下，2 左，3 右
+
+    // 空格位于某格时的合法相邻交换：count 个目标格子及对应方向，按方向顺序排列
+    struct AdjacentMoves {
+        uint8_t count = 0;
+        std::array<uint8_t, kDirections> target{};
+        std::array<uint8_t, kDirections> direction{};
+    };
+
+    int rows = 0;
+    int cols = 0;
+
+    // step[dir]：空格沿方向 dir 移动一格时格子下标的变化量
+    std::array<int, kDirections> step{};
+
+    // adjacent[pos]：空格位于 pos 时所有合法的相邻交换
+    std::array<AdjacentMoves, kMaxCells> adjacent{};
+
+    // ray_length[pos][dir]：空格位于 pos 时沿方向 dir 到棋盘边缘的格子数，即该方向批量位移的目标个数
+    std::array<std::array<uint8_t, kDirections>, kMaxCells> ray_length{};
+
+    // manhattan[tile][pos]：数字 tile 位于格子 pos 时到其目标位置的曼哈顿距离，空格 (tile 0) 恒为 0
+    std::array<std::array<uint8_t, kMaxCells>, kMaxCells> manhattan{};
+
+    // 数字 tile 从格子 from 移动到格子 to 时曼哈顿距离的变化量
+    int manhattan_delta(int tile, int from, int to) const {
+        return static_cast<int>(manhattan[tile][to]) - static_cast<int>(manhattan[tile][from]);
+    }
+};
+
+constexpr int shape_tables_abs(int x) { return x < 0 ? -x : x; }
+
+constexpr ShapeTables make_shape_tables(int rows, int cols) {
+    ShapeTables t{};
+    t.rows = rows;
+    t.cols = cols;
+    t.step = {-cols, cols, -1, 1};
+
+    for (int pos = 0; pos < rows * cols; ++pos) {
+        int r = pos / cols;
+        int c = pos % cols;
+        const int lengths[ShapeTables::kDirections] = {r, rows - 1 - r, c, cols - 1 - c};
+        for (int dir = 0; dir < ShapeTables::kDirections; ++dir) {
+            t.ray_length[pos][dir] = static_cast<uint8_t>(lengths[dir]);
+            if (lengths[dir] > 0) {
+                ShapeTables::AdjacentMoves& moves = t.adjacent[pos];
+                moves.target[moves.count] = static_cast<uint8_t>(pos + t.step[dir]);
+                moves.direction[moves.count] = static_cast<uint8_t>(dir);
+                ++moves.count;
+            }
+        }
+    }
+    for (int tile = 1; tile < rows * cols; ++tile) {
+        int target = tile - 1;
+        for (int pos = 0; pos < rows * cols; ++pos) {
+            t.manhattan[tile][pos] = static_cast<uint8_t>(shape_tables_abs(pos / cols - target / cols) +
+                                                          shape_tables_abs(pos % cols - target % cols));
+        }
+    }
+    return t;
+}
+
+// 运行期形状的查找表，每种形状只构造一次，线程安全，返回的引用在程序生命周期内有效
+const ShapeTables& shape_tables(int rows, int cols);
+
+#endif // SHAPE_TABLES_HPP
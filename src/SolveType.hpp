@@ -0,0 +1,10 @@
+#ifndef SOLVE_TYPE_HPP
+#define SOLVE_TYPE_HPP
+
+// 定义求解类型
+enum class SolveType {
+    AdjacentSwap, // 相邻交换计分
+    BlockShift    // 批量位移计分
+};
+
+#endif // SOLVE_TYPE_HPP
@@ -0,0 +1,82 @@
+#include "WalkingDistance.hpp"
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <utility>
+
+#include <spdlog/spdlog.h>
+
+int32_t WalkingDistanceTable::index_of(const std::vector<uint8_t>& counts, int blank_line) const {
+    std::string key(counts.begin(), counts.end());
+    key.push_back(static_cast<char>(blank_line));
+    auto it = index_.find(key);
+    return it == index_.end() ? kInvalid : it->second;
+}
+
+// 从目标状态出发 BFS；状态编号即发现顺序，所以 states 同时是 BFS 队列
+bool WalkingDistanceTable::generate() {
+    const int cells = lines_ * lines_;
+    std::string goal(cells + 1, '\0');
+    for (int line = 0; line < lines_; ++line) {
+        goal[line * lines_ + line] = static_cast<char>(line_length_);
+    }
+    goal[cells - 1] = static_cast<char>(line_length_ - 1); // 最后一条线上有一格是空格
+    goal[cells] = static_cast<char>(lines_ - 1);
+
+    std::vector<std::string> states{goal};
+    index_.emplace(goal, 0);
+    distances_.push_back(0);
+    for (size_t head = 0; head < states.size(); ++head) {
+        const std::string state = states[head];
+        const int blank_line = state[cells];
+        for (int direction = 0; direction < 2; ++direction) {
+            const int from_line = direction == 0 ? blank_line - 1 : blank_line + 1;
+            for (int goal_line = 0; goal_line < lines_; ++goal_line) {
+                int32_t target = kInvalid;
+                if (from_line >= 0 && from_line < lines_ && state[from_line * lines_ + goal_line] > 0) {
+                    std::string child = state;
+                    --child[from_line * lines_ + goal_line];
+                    ++child[blank_line * lines_ + goal_line];
+                    child[cells] = static_cast<char>(from_line);
+                    auto [it, inserted] = index_.emplace(child, static_cast<int32_t>(states.size()));
+                    if (inserted) {
+                        if (states.size() >= static_cast<size_t>(kMaxStates)) {
+                            return false;
+                        }
+                        states.push_back(std::move(child));
+                        distances_.push_back(static_cast<uint8_t>(distances_[head] + 1));
+                    }
+                    target = it->second;
+                }
+                transitions_.push_back(target);
+            }
+        }
+    }
+    max_distance_ = distances_.back();
+    return true;
+}
+
+std::shared_ptr<const WalkingDistanceTable> WalkingDistanceTable::get(int lines, int line_length) {
+    static std::mutex registry_mutex;
+    static std::map<std::pair<int, int>, std::shared_ptr<const WalkingDistanceTable>> registry;
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    auto found = registry.find({lines, line_length});
+    if (found != registry.end()) {
+        return found->second;
+    }
+    std::shared_ptr<WalkingDistanceTable> table(new WalkingDistanceTable(lines, line_length));
+    auto start = std::chrono::high_resolution_clock::now();
+    if (lines < 2 || line_length < 1 || !table->generate()) {
+        spdlog::default_logger()->warn("Walking distance table for {} lines of {} cells exceeds {} states; not generated.",
+                                       lines, line_length, kMaxStates);
+        table.reset();
+    } else {
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start);
+        spdlog::default_logger()->info("Walking distance table for {} lines of {} cells: {} states, max distance {}, built in {} ms.",
+                                       lines, line_length, table->state_count(), table->max_distance(), elapsed.count());
+    }
+    registry[{lines, line_length}] = table;
+    return table;
+}
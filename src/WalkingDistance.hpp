@@ -0,0 +1,52 @@
+#ifndef WALKING_DISTANCE_HPP
+#define WALKING_DISTANCE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Walking Distance（WD）表。
+// 只看数字所在的行而不看列：状态为 lines x lines 的计数矩阵 count[r][g]（第 r 行中目标行为 g 的数字个数）加上空格所在行，
+// 一次竖直移动把相邻行的一个数字移入空格所在行。从目标状态出发 BFS 得到每个抽象状态到目标的最少竖直移动数，
+// 它是原问题竖直移动数的下界；列同理（用转置形状的表），两者相加即 WD，且不小于曼哈顿距离。
+// 表同时记录每个状态在每种移动下的转移，搜索时由父节点的状态编号 O(1) 得到子节点的状态编号。
+//
+// 同一张表既可用于行（lines = N，line_length = M），也可用于列（lines = M，line_length = N）。
+class WalkingDistanceTable {
+public:
+    static constexpr int32_t kInvalid = -1;
+    static constexpr int kMaxStates = 1 << 22; // 超过此规模的形状不生成（4x4 只有 24,964 个状态，5x4、5x5 远超上限）
+
+    // lines 条线、每条 line_length 格的表，进程内缓存，线程安全；状态数超过 kMaxStates 时返回 nullptr
+    static std::shared_ptr<const WalkingDistanceTable> get(int lines, int line_length);
+
+    int lines() const { return lines_; }
+    int line_length() const { return line_length_; }
+    int state_count() const { return static_cast<int>(distances_.size()); }
+    int max_distance() const { return max_distance_; }
+
+    int distance(int32_t state) const { return distances_[state]; }
+
+    // 空格沿线的方向移动（up 为 true 表示空格移到上一条线），被移动的数字目标线为 goal_line
+    int32_t next(int32_t state, bool up, int goal_line) const {
+        return transitions_[(static_cast<size_t>(state) * 2 + (up ? 0 : 1)) * lines_ + goal_line];
+    }
+
+    // counts 为 lines x lines 的计数矩阵（行优先），blank_line 为空格所在线；不可达时返回 kInvalid
+    int32_t index_of(const std::vector<uint8_t>& counts, int blank_line) const;
+
+private:
+    WalkingDistanceTable(int lines, int line_length) : lines_(lines), line_length_(line_length) {}
+    bool generate();
+
+    int lines_;
+    int line_length_;
+    int max_distance_ = 0;
+    std::vector<uint8_t> distances_;      // [state]
+    std::vector<int32_t> transitions_;    // [(state * 2 + direction) * lines + goal_line]
+    std::unordered_map<std::string, int32_t> index_; // 计数矩阵 + 空格所在线 -> 状态编号
+};
+
+#endif // WALKING_DISTANCE_HPP
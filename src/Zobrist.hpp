@@ -0,0 +1,32 @@
+#ifndef ZOBRIST_HPP
+#define ZOBRIST_HPP
+
+#include <array>
+#include <cstdint>
+
+// Zobrist 哈希键：kZobristKeys[pos][tile] 为数字 tile 位于格子 pos 时的随机键。
+// 棋盘的哈希是所有 (格子, 数字) 键的异或，空格 (tile 0) 的键恒为 0，
+// 因此把数字 t 从格子 a 移到空格 b 时，哈希只需异或 keys[a][t] ^ keys[b][t]。
+constexpr int kZobristMaxCells = 64;
+
+constexpr uint64_t zobrist_splitmix64(uint64_t& state) {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+constexpr std::array<std::array<uint64_t, kZobristMaxCells>, kZobristMaxCells> make_zobrist_keys() {
+    std::array<std::array<uint64_t, kZobristMaxCells>, kZobristMaxCells> keys{};
+    uint64_t state = 0x5eed5eed5eed5eedULL;
+    for (int pos = 0; pos < kZobristMaxCells; ++pos) {
+        for (int tile = 1; tile < kZobristMaxCells; ++tile) {
+            keys[pos][tile] = zobrist_splitmix64(state);
+        }
+    }
+    return keys;
+}
+
+inline constexpr auto kZobristKeys = make_zobrist_keys();
+
+#endif // ZOBRIST_HPP
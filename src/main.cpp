@@ -1,5 +1,6 @@
 // main.cpp
 #include "PuzzleSolver.hpp"
+#include "HeuristicKernels.hpp"
 #include <iostream>
 #include <vector>
 #include <chrono> // 用于时间测量
@@ -8,11 +9,11 @@
 #include <spdlog/sinks/stdout_color_sinks.h> // 用于控制台彩色输出
 
 // 辅助函数：打印棋盘状态
-void print_board(const Board& board, const std::shared_ptr<spdlog::logger>& logger) {
+void print_board(int N, int M, const std::vector<int>& tiles, const std::shared_ptr<spdlog::logger>& logger) {
     std::string board_str = "";
-    for (int r = 0; r < board.N; ++r) {
-        for (int c = 0; c < board.M; ++c) {
-            int val = board.tiles[r * board.M + c];
+    for (int r = 0; r < N; ++r) {
+        for (int c = 0; c < M; ++c) {
+            int val = tiles[r * M + c];
             board_str += (val == 0 ? "  " : (val < 10 ? " " : "")) // 格式化输出，保持对齐
                       + std::to_string(val) + " ";
         }
@@ -28,30 +29,85 @@ int main(int argc, char* argv[]) {
     spdlog::set_level(spdlog::level::info); // 设置全局日志级别为信息级
     spdlog::set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%^%l%$] %v"); // 不显示线程ID
 
-    // 检查命令行参数，获取输入文件名和可选的时间限制
+    // 检查命令行参数：以 -- 开头的是求解选项，其余依次为输入文件名和可选的时间限制
     std::string input_filename;
     int time_limit_seconds = 0; // 默认为0，表示无时间限制
+    SolverOptions options;
+    std::vector<std::string> positional_args;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--", 0) != 0) {
+            positional_args.push_back(arg);
+        } else if (arg == "--engine=astar") {
+            options.engine = SearchEngine::AStar;
+        } else if (arg == "--engine=ida") {
+            options.engine = SearchEngine::IDAStar;
+        } else if (arg == "--heuristic=manhattan") {
+            options.heuristic = HeuristicKind::Manhattan;
+        } else if (arg == "--heuristic=linear-conflict") {
+            options.heuristic = HeuristicKind::LinearConflict;
+        } else if (arg == "--heuristic=walking-distance") {
+            options.heuristic = HeuristicKind::WalkingDistance;
+        } else if (arg == "--wd-linear-conflict") {
+            options.walking_distance_linear_conflict = true;
+        } else if (arg == "--heuristic=block-crossing") {
+            options.heuristic = HeuristicKind::BlockCrossing;
+        } else if (arg == "--heuristic=pdb") {
+            options.heuristic = HeuristicKind::PatternDatabase;
+        } else if (arg.rfind("--pdb=", 0) == 0) {
+            options.pattern_partition = arg.substr(6);
+        } else if (arg == "--pdb-reflect") {
+            options.pattern_reflection = true;
+        } else if (arg == "--pdb-dual") {
+            options.pattern_dual = true;
+        } else if (arg == "--pdb-prefilter=none") {
+            options.pattern_prefilter = PatternPrefilter::None;
+        } else if (arg == "--pdb-prefilter=manhattan") {
+            options.pattern_prefilter = PatternPrefilter::Manhattan;
+        } else if (arg == "--pdb-prefilter=linear-conflict") {
+            options.pattern_prefilter = PatternPrefilter::LinearConflict;
+        } else if (arg == "--pdb-prefilter=walking-distance") {
+            options.pattern_prefilter = PatternPrefilter::WalkingDistance;
+        } else if (arg == "--batch-children") {
+            options.batch_children = true;
+        } else if (arg == "--bpmx") {
+            options.pathmax = true;
+        } else if (arg == "--no-oracle") {
+            options.use_distance_oracle = false;
+        } else if (arg.rfind("--pdb-storage=", 0) == 0) {
+            if (!PatternStorage::parse(arg.substr(14), options.pattern_storage)) {
+                spdlog::error("Unknown pattern database storage: {}. Expected byte, 4bit or 2bit, optionally followed by -min<2..64>.", arg.substr(14));
+                return 1;
+            }
+        } else {
+            spdlog::error("Unknown option: {}. Supported options: --engine=astar|ida, --heuristic=manhattan|linear-conflict|walking-distance|pdb|block-crossing, "
+                          "--wd-linear-conflict, --pdb=<name|tiles>, --pdb-storage=<byte|4bit|2bit>[-min<B>], --pdb-reflect, --pdb-dual, "
+                          "--pdb-prefilter=none|manhattan|linear-conflict|walking-distance, --batch-children, --bpmx, --no-oracle", arg);
+            return 1;
+        }
+    }
 
-    if (argc > 1) {
-        input_filename = argv[1];
+    if (positional_args.size() > 0) {
+        input_filename = positional_args[0];
         spdlog::info("Reading puzzle from file: {}", input_filename);
     } else {
         input_filename = "puzzle_input.txt"; // 默认文件名
         spdlog::warn("No input file specified. Using default: {}", input_filename);
     }
 
-    if (argc > 2) {
+    if (positional_args.size() > 1) {
         try {
-            time_limit_seconds = std::stoi(argv[2]);
+            time_limit_seconds = std::stoi(positional_args[1]);
             if (time_limit_seconds < 0) {
                 time_limit_seconds = 0; // 负数时间限制视为无限制
                 spdlog::warn("Invalid time limit specified (negative). Setting to no limit.");
             }
         } catch (const std::invalid_argument& e) {
-            spdlog::error("Invalid time limit argument: {}. Must be an integer. Setting to no limit.", argv[2]);
+            spdlog::error("Invalid time limit argument: {}. Must be an integer. Setting to no limit.", positional_args[1]);
             time_limit_seconds = 0;
         } catch (const std::out_of_range& e) {
-            spdlog::error("Time limit argument out of range: {}. Setting to no limit.", argv[2]);
+            spdlog::error("Time limit argument out of range: {}. Setting to no limit.", positional_args[1]);
             time_limit_seconds = 0;
         }
     }
@@ -86,6 +142,8 @@ int main(int argc, char* argv[]) {
     // 设置线程数量
     int num_threads = std::thread::hardware_concurrency(); // 使用所有可用的核心
     if (num_threads == 0) num_threads = 4; // 如果无法检测到核心数，默认4个线程
+    spdlog::info("Heuristic kernel: {}", heuristic_kernel_name());
+    spdlog::info("Search engine: {}", options.engine == SearchEngine::IDAStar ? "IDA*" : "A*");
     spdlog::info("Detected hardware concurrency: {} threads. Using {} threads for solver.", std::thread::hardware_concurrency(), num_threads);
 
 
@@ -94,13 +152,12 @@ int main(int argc, char* argv[]) {
     // -------------------------------------------------------------
     spdlog::info("------------------------------------------");
     spdlog::info("Solving for Type 1: Adjacent Swap ({}x{} puzzle)", N, M);
-    Board initial_board_adj(N, M, initial_tiles);
-    print_board(initial_board_adj, console_logger);
+    print_board(N, M, initial_tiles, console_logger);
 
     PuzzleSolver solver_adj;
     auto start_time_adj = std::chrono::high_resolution_clock::now();
     // 查找前 1 个最优解，并传入时间限制
-    std::vector<Solution> solutions_adj = solver_adj.solve(initial_board_adj, SolveType::AdjacentSwap, 1, num_threads, time_limit_seconds);
+    std::vector<Solution> solutions_adj = solver_adj.solve(N, M, initial_tiles, SolveType::AdjacentSwap, 1, num_threads, time_limit_seconds, options);
     auto end_time_adj = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> diff_adj = end_time_adj - start_time_adj;
 
@@ -112,7 +169,7 @@ int main(int argc, char* argv[]) {
             spdlog::info("Solution {} (Cost: {} steps):", i + 1, solutions_adj[i].cost);
             // 打印路径中的每个棋盘状态
             for (const auto& board_state : solutions_adj[i].path) {
-                print_board(board_state, console_logger);
+                print_board(N, M, board_state, console_logger);
             }
             spdlog::info("--------------------");
         }
@@ -125,14 +182,12 @@ int main(int argc, char* argv[]) {
     // -------------------------------------------------------------
     spdlog::info("\n------------------------------------------");
     spdlog::info("Solving for Type 2: Sequential Block Shift ({}x{} puzzle)", N, M);
-    // 重新创建初始棋盘，以确保是原始状态
-    Board initial_board_block(N, M, initial_tiles);
-    print_board(initial_board_block, console_logger);
+    print_board(N, M, initial_tiles, console_logger);
 
     PuzzleSolver solver_block;
     auto start_time_block = std::chrono::high_resolution_clock::now();
     // 查找前 1 个最优解，并传入时间限制
-    std::vector<Solution> solutions_block = solver_block.solve(initial_board_block, SolveType::BlockShift, 1, num_threads, time_limit_seconds);
+    std::vector<Solution> solutions_block = solver_block.solve(N, M, initial_tiles, SolveType::BlockShift, 1, num_threads, time_limit_seconds, options);
     auto end_time_block = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> diff_block = end_time_block - start_time_block;
 
@@ -144,7 +199,7 @@ int main(int argc, char* argv[]) {
             spdlog::info("Solution {} (Cost: {} steps):", i + 1, solutions_block[i].cost);
             // 打印路径中的每个棋盘状态
             for (const auto& board_state : solutions_block[i].path) {
-                print_board(board_state, console_logger);
+                print_board(N, M, board_state, console_logger);
             }
             spdlog::info("--------------------");
         }
@@ -0,0 +1,60 @@
+// fsm_builder.cpp
+// 离线学习某一棋盘形状与求解类型的重复路径剪枝自动机，并写成 number_slider_solver 启动时读取的表文件。
+// 用法: fsm_builder <rows> <cols> <adjacent|block> [depth] [output]
+//   depth 缺省时使用求解器现场学习的默认深度；output 缺省时写到 MoveAutomaton::file_path 给出的位置
+#include "MoveAutomaton.hpp"
+
+#include <chrono>
+#include <string>
+
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+
+int main(int argc, char* argv[]) {
+    auto console_logger = spdlog::stdout_color_mt("fsm_builder");
+    spdlog::set_default_logger(console_logger);
+    spdlog::set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%^%l%$] %v");
+
+    if (argc < 4) {
+        spdlog::error("Usage: {} <rows> <cols> <adjacent|block> [depth] [output]", argv[0]);
+        return 1;
+    }
+    int rows = 0;
+    int cols = 0;
+    int depth = 0;
+    try {
+        rows = std::stoi(argv[1]);
+        cols = std::stoi(argv[2]);
+        if (argc > 4) depth = std::stoi(argv[4]);
+    } catch (const std::exception&) {
+        spdlog::error("Rows, cols and depth must be integers.");
+        return 1;
+    }
+    const std::string type_name = argv[3];
+    if (type_name != "adjacent" && type_name != "block") {
+        spdlog::error("Unknown solve type '{}'; expected 'adjacent' or 'block'.", type_name);
+        return 1;
+    }
+    if (rows <= 0 || cols <= 0 || rows * cols > 64 || depth < 0) {
+        spdlog::error("Invalid shape {}x{} or depth {}.", rows, cols, depth);
+        return 1;
+    }
+    const SolveType type = type_name == "adjacent" ? SolveType::AdjacentSwap : SolveType::BlockShift;
+    if (depth == 0) {
+        depth = type == SolveType::AdjacentSwap ? MoveAutomaton::kDefaultAdjacentDepth : MoveAutomaton::kDefaultBlockShiftDepth;
+    }
+    const std::string output = argc > 5 ? argv[5] : MoveAutomaton::file_path(rows, cols, type);
+
+    auto start_time = std::chrono::steady_clock::now();
+    MoveAutomaton automaton = MoveAutomaton::learn(rows, cols, type, depth);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_time;
+    spdlog::info("Learned {}x{} {} automaton to depth {} in {:.2f} seconds: {} forbidden strings, {} states, {} symbols.",
+                 rows, cols, type_name, depth, elapsed.count(), automaton.forbidden_count(), automaton.state_count(), automaton.symbol_count());
+
+    if (!automaton.save(output)) {
+        spdlog::error("Could not write {}.", output);
+        return 1;
+    }
+    spdlog::info("Wrote {}.", output);
+    return 0;
+}
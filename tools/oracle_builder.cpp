@@ -0,0 +1,59 @@
+// oracle_builder.cpp
+// 离线构造不超过 12 格的棋盘形状与求解类型的完全距离表，写成 number_slider_solver 求解时映射的表文件。
+// 用法: oracle_builder <rows> <cols> <adjacent|block|both> [output_dir]
+//   both 依次构造两种求解类型的表；output_dir 缺省时写到 DistanceOracle::file_path 给出的目录
+#include "DistanceOracle.hpp"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+
+int main(int argc, char* argv[]) {
+    auto console_logger = spdlog::stdout_color_mt("oracle_builder");
+    spdlog::set_default_logger(console_logger);
+    spdlog::set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%^%l%$] %v");
+
+    if (argc < 4) {
+        spdlog::error("Usage: {} <rows> <cols> <adjacent|block|both> [output_dir]", argv[0]);
+        return 1;
+    }
+    int rows = 0;
+    int cols = 0;
+    try {
+        rows = std::stoi(argv[1]);
+        cols = std::stoi(argv[2]);
+    } catch (const std::exception&) {
+        spdlog::error("Rows and cols must be integers.");
+        return 1;
+    }
+    const std::string type_name = argv[3];
+    std::vector<SolveType> types;
+    if (type_name == "adjacent" || type_name == "both") {
+        types.push_back(SolveType::AdjacentSwap);
+    }
+    if (type_name == "block" || type_name == "both") {
+        types.push_back(SolveType::BlockShift);
+    }
+    if (types.empty()) {
+        spdlog::error("Unknown solve type '{}'; expected 'adjacent', 'block' or 'both'.", type_name);
+        return 1;
+    }
+
+    for (SolveType type : types) {
+        const std::string default_path = DistanceOracle::file_path(rows, cols, type);
+        const std::string output = argc > 4 ? (std::filesystem::path(argv[4]) / std::filesystem::path(default_path).filename()).string() : default_path;
+        auto oracle = DistanceOracle::build(rows, cols, type);
+        if (!oracle) {
+            return 1;
+        }
+        if (!oracle->write_file(output)) {
+            spdlog::error("Could not write {}.", output);
+            return 1;
+        }
+        spdlog::info("Wrote {}.", output);
+    }
+    return 0;
+}
@@ -0,0 +1,166 @@
+// pdb_builder.cpp
+// 离线构造某一棋盘形状、求解类型与模式划分下的模式数据库，写成 number_slider_solver 启动时读取的表文件。
+// 用法: pdb_builder <rows> <cols> <adjacent|block> [partition] [output_dir] [--storage=<storage>] [--bench]
+//   partition 缺省时为该形状的默认划分，格式见 resolve_partition（如 "7-8" 或 "1,2,5,6/3,4,7,8"）；
+//   output_dir 缺省时写到 PatternDatabase::file_path 给出的目录；
+//   --storage 写出压缩表而不是原始表（见 PatternStorage::parse，如 "4bit" 或 "2bit-min4"）；
+//   --bench 从表目录读取原始表（没有时构造，不写文件），换算出压缩表，测量随机查表的速度与压缩造成的表值损失
+#include "PatternDatabase.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+
+namespace {
+
+// 在 positions 给出的模式位置上依次查表：返回每次查表的纳秒数，values 为各位置的表值。
+// 先查一遍把映射的表页调入，计时的是第二遍
+double time_lookups(const PatternDatabase& database, const std::vector<uint8_t>& positions, std::vector<int>& values) {
+    const size_t k = database.tiles().size();
+    const size_t samples = positions.size() / k;
+    values.resize(samples);
+    for (size_t i = 0; i < samples; ++i) {
+        values[i] = database.lookup(positions.data() + i * k);
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < samples; ++i) {
+        values[i] = database.lookup(positions.data() + i * k);
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / static_cast<double>(samples);
+}
+
+void bench(const PatternDatabase& raw, const PatternDatabase* compressed) {
+    constexpr size_t kSamples = 1 << 22;
+    const int k = static_cast<int>(raw.tiles().size());
+    const int cells = raw.rows() * raw.cols();
+    std::mt19937_64 rng(12345);
+    std::uniform_int_distribution<uint64_t> pick(0, raw.entry_count() - 1);
+    std::vector<uint8_t> positions(kSamples * k);
+    for (size_t i = 0; i < kSamples; ++i) {
+        unrank_partial(pick(rng), k, cells, positions.data() + i * k);
+    }
+
+    std::vector<int> raw_values;
+    const double raw_ns = time_lookups(raw, positions, raw_values);
+    spdlog::info("  byte: {:.2f} MB, {:.1f} ns/lookup", raw.table_bytes() / 1048576.0, raw_ns);
+    if (compressed == nullptr) {
+        return;
+    }
+    std::vector<int> values;
+    const double ns = time_lookups(*compressed, positions, values);
+    uint64_t lowered = 0;
+    uint64_t loss = 0;
+    for (size_t i = 0; i < kSamples; ++i) {
+        if (raw_values[i] == PatternDatabase::kUnreached) {
+            continue;
+        }
+        if (values[i] > raw_values[i]) {
+            spdlog::error("  {} overestimates: {} > {}.", compressed->storage().name(), values[i], raw_values[i]);
+            return;
+        }
+        lowered += values[i] < raw_values[i];
+        loss += static_cast<uint64_t>(raw_values[i] - values[i]);
+    }
+    spdlog::info("  {}: {:.2f} MB, {:.1f} ns/lookup, {:.3f}% of values lowered, mean loss {:.4f}", compressed->storage().name(),
+                 compressed->table_bytes() / 1048576.0, ns, 100.0 * lowered / kSamples, static_cast<double>(loss) / kSamples);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    auto console_logger = spdlog::stdout_color_mt("pdb_builder");
+    spdlog::set_default_logger(console_logger);
+    spdlog::set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%^%l%$] %v");
+
+    std::vector<std::string> args;
+    PatternStorage storage;
+    bool run_bench = false;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg.rfind("--storage=", 0) == 0) {
+            if (!PatternStorage::parse(arg.substr(10), storage)) {
+                spdlog::error("Unknown storage '{}'; expected byte, 4bit or 2bit, optionally followed by -min<2..64>.", arg.substr(10));
+                return 1;
+            }
+        } else if (arg == "--bench") {
+            run_bench = true;
+        } else {
+            args.push_back(arg);
+        }
+    }
+    if (args.size() < 3) {
+        spdlog::error("Usage: {} <rows> <cols> <adjacent|block> [partition] [output_dir] [--storage=<storage>] [--bench]", argv[0]);
+        return 1;
+    }
+    int rows = 0;
+    int cols = 0;
+    try {
+        rows = std::stoi(args[0]);
+        cols = std::stoi(args[1]);
+    } catch (const std::exception&) {
+        spdlog::error("Rows and cols must be integers.");
+        return 1;
+    }
+    const std::string type_name = args[2];
+    if (type_name != "adjacent" && type_name != "block") {
+        spdlog::error("Unknown solve type '{}'; expected 'adjacent' or 'block'.", type_name);
+        return 1;
+    }
+    if (rows <= 0 || cols <= 0 || rows * cols > 64) {
+        spdlog::error("Invalid shape {}x{}.", rows, cols);
+        return 1;
+    }
+    const SolveType type = type_name == "adjacent" ? SolveType::AdjacentSwap : SolveType::BlockShift;
+    const std::string spec = args.size() > 3 ? args[3] : "";
+    const std::vector<std::vector<int>> groups = resolve_partition(rows, cols, spec);
+    if (groups.empty()) {
+        spdlog::error("No partition '{}' for {}x{}.", spec, rows, cols);
+        return 1;
+    }
+
+    if (run_bench) {
+        if (args.size() > 4) {
+            setenv("NUMBER_SLIDER_PDB_DIR", args[4].c_str(), 1);
+        }
+        for (const std::vector<int>& tiles : groups) {
+            std::shared_ptr<const PatternDatabase> raw = PatternDatabase::get(rows, cols, type, tiles);
+            if (!raw) {
+                spdlog::info("Building pattern {} for the benchmark.", PatternDatabase::file_name(rows, cols, type, tiles));
+                raw = PatternDatabase::build(rows, cols, type, tiles);
+            }
+            if (!raw) {
+                return 1;
+            }
+            std::shared_ptr<const PatternDatabase> compressed = storage.compressed() ? PatternDatabase::compress(*raw, storage) : nullptr;
+            spdlog::info("Pattern {}:", PatternDatabase::file_name(rows, cols, type, tiles));
+            bench(*raw, compressed.get());
+        }
+        return 0;
+    }
+
+    for (const std::vector<int>& tiles : groups) {
+        const std::string output = args.size() > 4 ? (std::filesystem::path(args[4]) / PatternDatabase::file_name(rows, cols, type, tiles, storage)).string()
+                                                    : PatternDatabase::file_path(rows, cols, type, tiles, storage);
+        auto database = PatternDatabase::build(rows, cols, type, tiles);
+        if (!database) {
+            return 1;
+        }
+        if (storage.compressed()) {
+            database = PatternDatabase::compress(*database, storage);
+        }
+        if (!database->write_file(output)) {
+            spdlog::error("Could not write {}.", output);
+            return 1;
+        }
+        spdlog::info("Wrote {} ({} entries, {:.2f} MB, max value {}, checksum {:016x}).", output, database->entry_count(),
+                     database->table_bytes() / 1048576.0, database->max_value(), database->checksum());
+    }
+    return 0;
+}